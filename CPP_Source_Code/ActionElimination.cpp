@@ -0,0 +1,120 @@
+/*
+* MIT License
+*
+* Copyright (c) 2024 Anders Reenberg Andersen and Jesper Fink Andersen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "ActionElimination.h"
+#include <algorithm>
+#include <limits>
+
+ActionElimination::ActionElimination():
+    lower(-numeric_limits<double>::infinity()),
+    upper(numeric_limits<double>::infinity()),
+    parallel(true)
+{
+}
+
+ActionElimination::ActionElimination(const ActionElimination& orig):
+    lower(orig.lower),
+    upper(orig.upper),
+    parallel(orig.parallel),
+    offsets(orig.offsets),
+    actions(orig.actions),
+    counts(orig.counts),
+    gaps(orig.gaps)
+{
+}
+
+ActionElimination::~ActionElimination() {
+}
+
+void ActionElimination::initialize(ModelType * mdl, bool par){
+    parallel = par;
+    int nStates = mdl->getNumberOfStates();
+    offsets.assign(nStates + 1, 0);
+    counts.resize(nStates);
+    for (int sidx = 0; sidx < nStates; sidx++) {
+        counts[sidx] = mdl->getNumberOfActions(sidx);
+        offsets[sidx + 1] = offsets[sidx] + counts[sidx];
+    }
+    actions.resize(offsets[nStates]);
+    gaps.assign(offsets[nStates], 0.0);
+    for (int sidx = 0; sidx < nStates; sidx++) {
+        for (int aidx = 0; aidx < counts[sidx]; aidx++) {
+            actions[offsets[sidx] + aidx] = aidx;
+        }
+    }
+    lower = -numeric_limits<double>::infinity();
+    upper = numeric_limits<double>::infinity();
+}
+
+void ActionElimination::improvementSweep(double diffMin, double diffMax, double discount){
+    //bounds on v* - v_old from the sweep itself: v_old + diffMin/(1-discount) <= v* <= v_old + diffMax/(1-discount)
+    lower = max(lower, diffMin / (1 - discount));
+    upper = min(upper, diffMax / (1 - discount));
+
+    //the gaps were recorded for v_old. The list of each state is compacted in place and keeps
+    //its order, such that ties are broken as without elimination.
+    double threshold = discount * max(upper - lower, 0.0); //the best action (gap 0) stays if rounding crosses the bounds
+    int nStates = counts.size();
+    #pragma omp parallel for if(parallel)
+    for (int sidx = 0; sidx < nStates; sidx++) {
+        int * list = &actions[offsets[sidx]];
+        double * stateGaps = &gaps[offsets[sidx]];
+        int count = 0;
+        for (int k = 0; k < counts[sidx]; k++) {
+            if (stateGaps[k] <= threshold) {
+                list[count++] = list[k];
+            }
+        }
+        counts[sidx] = count;
+    }
+
+    //MacQueen bounds for v: v + discount/(1-discount)*diffMin <= v* <= v + discount/(1-discount)*diffMax
+    //(Puterman, Proposition 6.6.3)
+    shiftBounds(diffMin, diffMax);
+    lower = max(lower, discount / (1 - discount) * diffMin);
+    upper = min(upper, discount / (1 - discount) * diffMax);
+}
+
+void ActionElimination::evaluationSweep(double diffMin, double diffMax, double discount){
+    //v* >= v_policy >= v + discount/(1-discount)*diffMin
+    shiftBounds(diffMin, diffMax);
+    lower = max(lower, discount / (1 - discount) * diffMin);
+}
+
+void ActionElimination::shiftBounds(double diffMin, double diffMax){
+    lower -= diffMax;
+    upper -= diffMin;
+}
+
+long long ActionElimination::numberOfActiveActions(){
+    long long total = 0;
+    for (size_t sidx = 0; sidx < counts.size(); sidx++) {
+        total += counts[sidx];
+    }
+    return total;
+}
+
+long long ActionElimination::numberOfAllActions(){
+    return offsets.empty() ? 0 : offsets.back();
+}
@@ -0,0 +1,87 @@
+/*
+* MIT License
+*
+* Copyright (c) 2024 Anders Reenberg Andersen and Jesper Fink Andersen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "ModelType.h"
+#include <vector>
+
+using namespace std;
+
+#ifndef ACTIONELIMINATION_H
+#define ACTIONELIMINATION_H
+
+//Action elimination for the discounted reward criterion with standard updates (Puterman, Section 6.7).
+//The scalars lower and upper bound v* - v, where v is the current value vector. They are tightened
+//by the MacQueen bounds of each improvement sweep and moved along with v by the evaluation sweeps.
+//Since r(s,a) + discount*P(s,a)v + discount*[lower,upper] contains the optimal action value of (s,a),
+//an action whose value is more than discount*(upper-lower) below the best one of its state is never
+//optimal. The improvement sweeps record how far each active action is below the best one, and the
+//actions proven suboptimal are removed from the list of active actions for the rest of the solve.
+class ActionElimination {
+public:
+
+    ActionElimination();
+    ActionElimination(const ActionElimination& orig);
+    virtual ~ActionElimination();
+
+    //VARIABLES
+    double lower, upper; //bounds on v* - v
+
+    //METHODS
+    void initialize(ModelType * mdl, bool parallel); //all actions are active and the bounds are infinite
+    int numberOfActions(int sidx); //number of active actions of state sidx
+    const int * getActions(int sidx); //active actions of state sidx in increasing order
+    void storeValues(int sidx, const double * values, double valBest); //values[k] is the value of getActions(sidx)[k] in the current improvement sweep
+    void improvementSweep(double diffMin, double diffMax, double discount); //after v = L v_old: eliminates actions and updates the bounds
+    void evaluationSweep(double diffMin, double diffMax, double discount); //after v = L_policy v_old
+    void shiftBounds(double diffMin, double diffMax); //after any other change of v
+    long long numberOfActiveActions();
+    long long numberOfAllActions();
+
+private:
+
+    //VARIABLES
+    bool parallel;
+    vector<long long> offsets; //the active actions of state s are actions[offsets[s]] to actions[offsets[s]+counts[s]-1]
+    vector<int> actions;
+    vector<int> counts;
+    vector<double> gaps; //gaps[offsets[s]+k] is the best value of state s minus the value of actions[offsets[s]+k]
+
+};
+
+inline int ActionElimination::numberOfActions(int sidx){
+    return counts[sidx];
+}
+
+inline const int * ActionElimination::getActions(int sidx){
+    return &actions[offsets[sidx]];
+}
+
+inline void ActionElimination::storeValues(int sidx, const double * values, double valBest){
+    double * stateGaps = &gaps[offsets[sidx]];
+    for (int k = 0; k < counts[sidx]; k++) {
+        stateGaps[k] = valBest - values[k];
+    }
+}
+
+#endif /* ACTIONELIMINATION_H */
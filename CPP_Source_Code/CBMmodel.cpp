@@ -167,9 +167,10 @@ CBMmodel::~CBMmodel() {
 //class functions
 double CBMmodel::reward(int &sidx, int &aidx) {
     //reward function
-    r = 0;
-    set_up = false;
-    fail_count = 0;
+    int s_i, a_i;
+    double r = 0;
+    bool set_up = false;
+    int fail_count = 0;
     for(int i = 0; i < N; ++i) {
 		s_i = sidxMat[sidx][i];//i'th component state
 		a_i = aidxMat[aidx][i];
@@ -191,9 +192,8 @@ double CBMmodel::reward(int &sidx, int &aidx) {
 
 double CBMmodel::transProb(int &sidx, int &aidx, int &jidx) {
 	//transition probability function
-
-	//int step;
-	prob = 1;
+	int s_i, a_i, j_i, step;
+	double prob = 1;
 	for (int i = 0; i<N; ++i) {
 		j_i = sidxMat[jidx][i]; //i'th component state
 		s_i = sidxMat[sidx][i];
@@ -211,62 +211,14 @@ double CBMmodel::transProb(int &sidx, int &aidx, int &jidx) {
 			prob *= pCompMat[i][j_i];
 		}
 	}
-	psj = prob; //set stored transition probability
 	return prob;
 }
 
-void CBMmodel::updateTransProbNextState(int sidx, int aidx, int jidx) {
-	//void CBMmodel::updateTransProbNextStateOptimized(int sidx, int aidx, int jidx) {
-	//updates psj and nextState, which are assumed to match.
-	//That is, input jidx should be nextState.
-
-	int step;
-	for (int i = 0; i<N; ++i) {
-		j_i = sidxMat[jidx][i]; //i'th component state
-		s_i = sidxMat[sidx][i];
-		a_i = aidxMat[aidx][i];
-
-		//assert(a_i == 1 || (a_i == 0 && j_i >= s_i));//check valid transition
-
-		if (a_i == 0) {
-			step = j_i - s_i;
-		} else {
-			step = j_i;
-		}
-
-		if (j_i<L) {
-			nextState += intPow(L + 1, i); //increment i'th component by one
-			//psj /= pCompMat[i][step]; //psj should be divided by what was previously used to calc component transition
-			if (j_i + 1 < L) {
-				psj *= pCompMat[i][step + 1] / pCompMat[i][step]; // still lower than L after increment
-			} else {
-				if (a_i == 0) {
-					psj *= pFailCompMat[i][s_i] / pCompMat[i][step];
-				} else {
-					psj *= pCompMat[i][j_i + 1] / pCompMat[i][step]; //going from 0 to L here
-				}
-			}
-			break; //we are done
-		} else {
-			nextState -= step * intPow(L + 1, i); //reset back to s_i or 0
-			//here j_i=L so psj was formely multiplied with a fail probability
-			if (a_i == 0) { //went from s_i to L
-				psj /= pFailCompMat[i][s_i];
-				if (s_i < L) {
-					psj *= pCompMat[i][0];
-				}
-			} else {
-				psj *= pCompMat[i][0] / pCompMat[i][L];
-			}
-		}
-	}
-}
-
 int CBMmodel::postDecisionIdx(int &sidx, int &aidx) {
-	//int CBMmodel::postDecisionIdxOptimized(int sidx, int aidx) {
 	//state index right after replacement, which is
 	//assumed instantaneous so components are set to age 0
-	pdidx = sidx;
+	int s_i, a_i;
+	int pdidx = sidx;
 
 	for (int i = 0; i<N; ++i) {
 		s_i = sidxMat[sidx][i];
@@ -275,37 +227,55 @@ int CBMmodel::postDecisionIdx(int &sidx, int &aidx) {
 			pdidx -= (s_i)*intPow(L + 1, i); // sets it to 0
 		}
 	}
-	nextState = pdidx; //store as the "first" next state
 	return pdidx;
 }
 
 
 void CBMmodel::updateNextState(int &sidx, int &aidx, int &jidx) {
 	//increment one component's deterioration level.
-	if (jidx != -1) {
-		nextState = jidx;
-	} else {
-		jidx = nextState; // default jidx value is current nextState
-	}
-	done = false;
+	int s_i, a_i, j_i;
+	bool done = false;
 	for (int i = 0; i<N; ++i) {
 		j_i = sidxMat[jidx][i]; //i'th component state
 		s_i = sidxMat[sidx][i];
 		a_i = aidxMat[aidx][i];
 
 		if (!done && j_i<L) { //non-replacements
-			nextState += intPow(L + 1, i);
+			jidx += intPow(L + 1, i);
 			done = true;
 		} else if (!done) {
 			if (a_i == 0) {
-				nextState -= (j_i - s_i)*intPow(L + 1, i); //reset back to s_i
+				jidx -= (j_i - s_i)*intPow(L + 1, i); //reset back to s_i
 			} else {
-				nextState -= (j_i)*intPow(L + 1, i); //reset back to 0
+				jidx -= (j_i)*intPow(L + 1, i); //reset back to 0
 			}
 		}
 	}
 }
 
+TransitionRow CBMmodel::getRow(int &sidx, int &aidx, RowBuffer &buf) {
+	//enumerates the reachable states, starting from the post-decision state,
+	//and stores them and their probabilities in buf
+	buf.probs.clear();
+	buf.cols.clear();
+
+	int pdidx = postDecisionIdx(sidx, aidx);
+	int jidx = pdidx;
+	do {
+		buf.probs.push_back(transProb(sidx, aidx, jidx));
+		buf.cols.push_back(jidx);
+		updateNextState(sidx, aidx, jidx);
+	} while (jidx != pdidx);
+
+	TransitionRow row;
+	row.probs = buf.probs.data();
+	row.probsSingle = NULL;
+	row.cols = buf.cols.data();
+	row.colDeltas = NULL;
+	row.colBase = 0;
+	row.length = buf.cols.size();
+	return row;
+}
 
 int CBMmodel::intPow(int a, int b) {
     int i = 1;
@@ -352,31 +322,8 @@ int CBMmodel::getNumberOfStates(){
     return numberOfStates;
 }
 
-void CBMmodel::updateNumberOfActions(int &sidx){	
-}
-
-int CBMmodel::getNumberOfActions(){
-    return numberOfActions;
-}      
-
-int * CBMmodel::getNextState(){
-    return &nextState;
-}
-
-double CBMmodel::getPsj(){
-    return psj;
-}
-
-int CBMmodel::getColumnIdx(int &sidx, int &aidx, int &cidx){
-	return 0;
-}
-
-int CBMmodel::getNumberOfJumps(int &sidx, int &aidx){
-	return 0;
-}
-
 int CBMmodel::getNumberOfActions(int &sidx){
-	return 0;
+	return numberOfActions;
 }
 
 //int CBMmodel::getPolicy(int sidx){
@@ -385,4 +332,4 @@ int CBMmodel::getNumberOfActions(int &sidx){
 //
 //void CBMmodel::assignPolicy(int sidx, int action){
 //    policy[sidx] = action;
-//}
+//}
\ No newline at end of file
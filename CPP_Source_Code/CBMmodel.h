@@ -32,7 +32,7 @@
 
 using namespace std;
 
-class CBMmodel : public ModelType{
+class CBMmodel final : public ModelType{
 public:
     
     //constructor and destructor
@@ -75,9 +75,6 @@ public:
     vector<vector<double>> pCompMat; //component transition probs.
 	vector<vector<double>> pFailCompMat; //sum of element in pCompMat
     //auxiliary variables
-    int nextState; //next state to process
-    double psj; //transition probability from state s to j
-	int s_i, a_i, j_i;
 	vector<vector<int>> sidxMat; // (sidx,i)'th element contains s_i for state index sidx
 	vector<vector<int>> aidxMat; // (aidx,i)'th element contains a_i for action index aidx
     
@@ -85,29 +82,17 @@ public:
         
     //GENERIC METHODS    
     double reward(int &sidx, int &aidx) override;
-    double transProb(int &sidx, int &aidx, int &jidx) override;
-    void updateNextState(int &sidx, int &aidx, int &jidx) override;
-    int postDecisionIdx(int &sidx, int &aidx) override;
+    TransitionRow getRow(int &sidx, int &aidx, RowBuffer &buf) override;
     double getDiscount() override;
     int getNumberOfStates() override;
-    void updateNumberOfActions(int &sidx) override;
-    int getNumberOfActions() override;
     int getNumberOfActions(int &sidx) override;
-    int * getNextState() override;
-    double getPsj() override;
-    int getNumberOfJumps(int &sidx, int &aidx) override; //not used
-    int getColumnIdx(int &sidx, int &aidx, int &cidx) override; //not used
     
     //SPECIAL METHODS
-    void updateTransProbNextState(int, int, int);
+    double transProb(int &sidx, int &aidx, int &jidx);
+    int postDecisionIdx(int &sidx, int &aidx); //first state reachable from sidx
+    void updateNextState(int &sidx, int &aidx, int &jidx); //moves jidx to the next reachable state
     int intPow(int, int);
     void importComponentProbs(string path);
-    
-private:
-
-    double r,prob;
-    bool set_up,done;
-    int fail_count,step,pdidx;
 
 };
 
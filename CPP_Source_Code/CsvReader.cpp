@@ -0,0 +1,283 @@
+/*
+* MIT License
+*
+* Copyright (c) 2024 Anders Reenberg Andersen and Jesper Fink Andersen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "CsvReader.h"
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <climits>
+#include <omp.h>
+
+static const int chunksPerThread = 8; //chunks of the file per thread, which even out differences in the line lengths
+
+//powers of ten that are exact in double precision
+static const double exactPowers[23] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+static inline bool isBlank(char c){
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static inline bool isDigit(char c){
+    return c >= '0' && c <= '9';
+}
+
+static inline void trim(const char * &begin, const char * &end){
+    while (begin < end && isBlank(*begin)) {
+        begin++;
+    }
+    while (end > begin && isBlank(*(end - 1))) {
+        end--;
+    }
+}
+
+static bool isBlankLine(const char * begin, const char * end){
+    trim(begin, end);
+    return begin == end;
+}
+
+//parses a non-negative integer that fills the field [begin,end)
+static bool parseIndex(const char * begin, const char * end, int &value){
+    trim(begin, end);
+    if (begin == end) {
+        return false;
+    }
+    long long result = 0;
+    for (const char * p = begin; p < end; p++) {
+        if (!isDigit(*p) || result > INT_MAX) {
+            return false;
+        }
+        result = result * 10 + (*p - '0');
+    }
+    if (result > INT_MAX) {
+        return false;
+    }
+    value = (int)result;
+    return true;
+}
+
+//parses a decimal number that fills the field [begin,end). If the digits fit in a double and the
+//exponent is small, the number is the result of a single (correctly rounded) multiplication or
+//division, which is the same as the result of strtod. Other numbers are converted by strtod.
+static bool parseValue(const char * begin, const char * end, double &value){
+    trim(begin, end);
+    if (begin == end) {
+        return false;
+    }
+    const char * p = begin;
+    bool negative = false;
+    if (*p == '-' || *p == '+') {
+        negative = *p == '-';
+        p++;
+    }
+    unsigned long long significand = 0;
+    int digits = 0; //significant digits in significand
+    int exponent = 0;
+    bool anyDigits = false;
+    bool exact = true;
+    for (; p < end && isDigit(*p); p++) {
+        anyDigits = true;
+        if (digits < 19) {
+            significand = significand * 10 + (*p - '0');
+            digits += significand != 0;
+        } else {
+            exact = false;
+        }
+    }
+    if (p < end && *p == '.') {
+        p++;
+        for (; p < end && isDigit(*p); p++) {
+            anyDigits = true;
+            if (digits < 19) {
+                significand = significand * 10 + (*p - '0');
+                digits += significand != 0;
+                exponent--;
+            } else {
+                exact = false;
+            }
+        }
+    }
+    if (anyDigits && p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        int sign = 1;
+        if (p < end && (*p == '-' || *p == '+')) {
+            sign = *p == '-' ? -1 : 1;
+            p++;
+        }
+        if (p == end || !isDigit(*p)) {
+            return false;
+        }
+        int e = 0;
+        for (; p < end && isDigit(*p); p++) {
+            if (e < 100000) {
+                e = e * 10 + (*p - '0');
+            }
+        }
+        exponent += sign * e;
+    }
+    if (anyDigits && p == end && exact && significand <= (1ULL << 53) && exponent >= -22 && exponent <= 22) {
+        value = exponent < 0 ? (double)significand / exactPowers[-exponent] : (double)significand * exactPowers[exponent];
+        if (negative) {
+            value = -value;
+        }
+        return true;
+    }
+    //long numbers, large exponents, inf and nan
+    char field[64];
+    if (end - begin >= (long)sizeof(field)) {
+        string longField(begin, end);
+        char * last;
+        value = strtod(longField.c_str(), &last);
+        return last == longField.c_str() + longField.size();
+    }
+    memcpy(field, begin, end - begin);
+    field[end - begin] = '\0';
+    char * last;
+    value = strtod(field, &last);
+    return last == field + (end - begin);
+}
+
+CsvReader::CsvReader():
+    sep(','),
+    nIndices(0),
+    nValues(0)
+{
+}
+
+CsvReader::CsvReader(const CsvReader& orig) {
+}
+
+CsvReader::~CsvReader() {
+}
+
+bool CsvReader::read(string fileName, char sep, bool header, int nIndices, int nValues){
+    this->sep = sep;
+    this->nIndices = nIndices;
+    this->nValues = nValues;
+    indices.assign(nIndices, vector<int>());
+    values.assign(nValues, vector<double>());
+    if (!file.open(fileName)) {
+        return false;
+    }
+    const char * begin = file.data();
+    const char * end = begin + file.size();
+    long long firstLine = 1;
+    if (header) {
+        const char * eol = (const char *)memchr(begin, '\n', end - begin);
+        begin = eol == NULL ? end : eol + 1;
+        firstLine = 2;
+    }
+
+    //split the file into chunks of whole lines
+    int nChunks = omp_get_max_threads() * chunksPerThread;
+    vector<const char *> chunks(nChunks + 1);
+    chunks[0] = begin;
+    for (int c = 1; c < nChunks; c++) {
+        const char * p = begin + (end - begin) / nChunks * c;
+        if (p <= chunks[c - 1]) {
+            p = chunks[c - 1];
+        } else {
+            const char * eol = (const char *)memchr(p, '\n', end - p);
+            p = eol == NULL ? end : eol + 1;
+        }
+        chunks[c] = p;
+    }
+    chunks[nChunks] = end;
+
+    //count the lines and the non-empty lines of each chunk to find where their fields are stored
+    vector<long long> lineOffsets(nChunks + 1, 0), rowOffsets(nChunks + 1, 0);
+    #pragma omp parallel for schedule(dynamic)
+    for (int c = 0; c < nChunks; c++) {
+        for (const char * p = chunks[c]; p < chunks[c + 1];) {
+            const char * eol = (const char *)memchr(p, '\n', chunks[c + 1] - p);
+            const char * lineEnd = eol == NULL ? chunks[c + 1] : eol;
+            lineOffsets[c + 1]++;
+            rowOffsets[c + 1] += !isBlankLine(p, lineEnd);
+            p = lineEnd + 1;
+        }
+    }
+    for (int c = 0; c < nChunks; c++) {
+        lineOffsets[c + 1] += lineOffsets[c];
+        rowOffsets[c + 1] += rowOffsets[c];
+    }
+    for (int f = 0; f < nIndices; f++) {
+        indices[f].resize(rowOffsets[nChunks]);
+    }
+    for (int f = 0; f < nValues; f++) {
+        values[f].resize(rowOffsets[nChunks]);
+    }
+
+    //parse the fields
+    vector<long long> errors(nChunks, -1); //first line of each chunk that could not be parsed
+    #pragma omp parallel for schedule(dynamic)
+    for (int c = 0; c < nChunks; c++) {
+        long long line = firstLine + lineOffsets[c];
+        long long row = rowOffsets[c];
+        for (const char * p = chunks[c]; p < chunks[c + 1]; line++) {
+            const char * eol = (const char *)memchr(p, '\n', chunks[c + 1] - p);
+            const char * lineEnd = eol == NULL ? chunks[c + 1] : eol;
+            if (!isBlankLine(p, lineEnd)) {
+                if (!parseLine(p, lineEnd, row)) {
+                    errors[c] = line;
+                    break;
+                }
+                row++;
+            }
+            p = lineEnd + 1;
+        }
+    }
+    file.close();
+    for (int c = 0; c < nChunks; c++) {
+        if (errors[c] >= 0) {
+            cerr << "Error: Unable to parse line " << errors[c] << " of " << fileName << endl;
+            indices.assign(nIndices, vector<int>());
+            values.assign(nValues, vector<double>());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CsvReader::parseLine(const char * begin, const char * end, long long row){
+    const char * p = begin;
+    for (int f = 0; f < nIndices + nValues; f++) {
+        if (p > end) {
+            return false; //too few fields
+        }
+        const char * fieldEnd = (const char *)memchr(p, sep, end - p);
+        if (fieldEnd == NULL) {
+            fieldEnd = end;
+        }
+        bool parsed = f < nIndices ? parseIndex(p, fieldEnd, indices[f][row]) : parseValue(p, fieldEnd, values[f - nIndices][row]);
+        if (!parsed) {
+            return false;
+        }
+        p = fieldEnd + 1;
+    }
+    return true;
+}
+
+long long CsvReader::numberOfLines(){
+    return indices.empty() ? (values.empty() ? 0 : values[0].size()) : indices[0].size();
+}
@@ -0,0 +1,67 @@
+/*
+* MIT License
+*
+* Copyright (c) 2024 Anders Reenberg Andersen and Jesper Fink Andersen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "MappedFile.h"
+#include <vector>
+#include <string>
+
+using namespace std;
+
+#ifndef CSVREADER_H
+#define CSVREADER_H
+
+//Reader for the comma-separated model files (rewards and transition probabilities). The file is mapped
+//into memory and split into chunks of whole lines, which are parsed in parallel. The first nIndices
+//fields of each line are non-negative integers (state and action indices), and the next nValues fields
+//are floating-point numbers. Further fields and empty lines are ignored. The fields of all lines are
+//stored column by column in the order of the file.
+class CsvReader {
+public:
+
+    CsvReader();
+    CsvReader(const CsvReader& orig);
+    virtual ~CsvReader();
+
+    //VARIABLES
+    vector<vector<int>> indices; //indices[c][i] is index field c of line i
+    vector<vector<double>> values; //values[c][i] is value field c of line i
+
+    //METHODS
+    bool read(string fileName, char sep, bool header, int nIndices, int nValues); //prints an error and returns false if the file cannot be parsed
+    long long numberOfLines(); //number of non-empty lines read (without the header)
+
+private:
+
+    //VARIABLES
+    MappedFile file;
+    char sep;
+    int nIndices;
+    int nValues;
+
+    //METHODS
+    bool parseLine(const char * begin, const char * end, long long row); //parses the fields of a line into row of indices and values
+
+};
+
+#endif /* CSVREADER_H */
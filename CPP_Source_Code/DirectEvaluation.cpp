@@ -0,0 +1,232 @@
+/*
+* MIT License
+*
+* Copyright (c) 2024 Anders Reenberg Andersen and Jesper Fink Andersen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "DirectEvaluation.h"
+#include <algorithm>
+#include <math.h>
+#include <omp.h>
+
+DirectEvaluation::DirectEvaluation(bool parallel):
+    parallel(parallel),
+    n(0),
+    discount(0.0),
+    maxRank(0),
+    factorizations(0)
+{
+}
+
+DirectEvaluation::DirectEvaluation(const DirectEvaluation& orig):
+    parallel(orig.parallel),
+    n(orig.n),
+    discount(orig.discount),
+    maxRank(orig.maxRank),
+    factorizations(orig.factorizations),
+    lu(orig.lu),
+    basePolicy(orig.basePolicy),
+    updatedStates(orig.updatedStates),
+    updateColumns(orig.updateColumns)
+{
+}
+
+DirectEvaluation::~DirectEvaluation() {
+}
+
+void DirectEvaluation::clear(){
+    lu.clear();
+    basePolicy.clear();
+    updatedStates.clear();
+    updateColumns.clear();
+    n = 0;
+}
+
+int DirectEvaluation::getRank(){
+    return updatedStates.size();
+}
+
+int DirectEvaluation::getFactorizations(){
+    return factorizations;
+}
+
+bool DirectEvaluation::evaluate(ModelType * mdl, const vector<int> &policy, double dis, vector<double> &v){
+    if (lu.empty() || mdl->getNumberOfStates() != n || dis != discount) {
+        discount = dis;
+        if (!factorize(mdl, policy)) {
+            return false;
+        }
+    }
+
+    //states where the policy differs from the factorized one
+    vector<int> changed;
+    for (int sidx = 0; sidx < n; sidx++) {
+        if (policy[sidx] != basePolicy[sidx]) {
+            changed.push_back(sidx);
+        }
+    }
+    if ((int)changed.size() > maxRank) {
+        if (!factorize(mdl, policy)) {
+            return false;
+        }
+        changed.clear();
+    }
+
+    //columns of states that were already updated in the last evaluation are reused
+    //(both lists are sorted), and the remaining ones are computed with the factorization
+    int rank = changed.size();
+    vector<vector<double> > columns(rank);
+    vector<int> missing;
+    size_t old = 0;
+    for (int k = 0; k < rank; k++) {
+        while (old < updatedStates.size() && updatedStates[old] < changed[k]) {
+            old++;
+        }
+        if (old < updatedStates.size() && updatedStates[old] == changed[k]) {
+            columns[k].swap(updateColumns[old]);
+        } else {
+            missing.push_back(k);
+        }
+    }
+    #pragma omp parallel for schedule(dynamic) if(parallel)
+    for (int m = 0; m < (int)missing.size(); m++) {
+        vector<double> &z = columns[missing[m]];
+        z.assign(n, 0.0);
+        z[changed[missing[m]]] = 1.0;
+        lu.solve(z);
+    }
+    updatedStates.swap(changed);
+    updateColumns.swap(columns);
+
+    //y = A_base^-1 r
+    vector<double> y(n);
+    #pragma omp parallel for if(parallel)
+    for (int sidx = 0; sidx < n; sidx++) {
+        int aidx = policy[sidx];
+        y[sidx] = mdl->reward(sidx, aidx);
+    }
+    lu.solve(y);
+    if (rank == 0) {
+        v.swap(y);
+        return true;
+    }
+
+    //A = A_base + U V' with U = [e_s] and V'x = -discount*(P - P_base)(s,:) x for the updated states s.
+    //Woodbury: A^-1 r = y - Z C^-1 V'y with Z = A_base^-1 U and C = I + V'Z.
+    vector<double> C(rank * rank), w(rank);
+    #pragma omp parallel if(parallel)
+    {
+        RowBuffer buf; //thread-local row storage
+        #pragma omp for schedule(dynamic)
+        for (int i = 0; i < rank; i++) {
+            int sidx = updatedStates[i];
+            int aidx = policy[sidx];
+            w[i] = -discount * rowDifference(mdl, sidx, aidx, y, buf);
+            for (int j = 0; j < rank; j++) {
+                C[i * rank + j] = (i == j ? 1.0 : 0.0) - discount * rowDifference(mdl, sidx, aidx, updateColumns[j], buf);
+            }
+        }
+    }
+
+    //solve C w = V'y with Gaussian elimination and partial pivoting
+    for (int k = 0; k < rank; k++) {
+        int pivot = k;
+        for (int i = k + 1; i < rank; i++) {
+            if (fabs(C[i * rank + k]) > fabs(C[pivot * rank + k])) {
+                pivot = i;
+            }
+        }
+        if (pivot != k) {
+            for (int j = 0; j < rank; j++) {
+                swap(C[k * rank + j], C[pivot * rank + j]);
+            }
+            swap(w[k], w[pivot]);
+        }
+        for (int i = k + 1; i < rank; i++) {
+            double factor = C[i * rank + k] / C[k * rank + k];
+            for (int j = k; j < rank; j++) {
+                C[i * rank + j] -= factor * C[k * rank + j];
+            }
+            w[i] -= factor * w[k];
+        }
+    }
+    for (int k = rank - 1; k >= 0; k--) {
+        for (int j = k + 1; j < rank; j++) {
+            w[k] -= C[k * rank + j] * w[j];
+        }
+        w[k] /= C[k * rank + k];
+    }
+
+    #pragma omp parallel for if(parallel)
+    for (int sidx = 0; sidx < n; sidx++) {
+        double correction = 0;
+        for (int k = 0; k < rank; k++) {
+            correction += updateColumns[k][sidx] * w[k];
+        }
+        y[sidx] -= correction;
+    }
+    v.swap(y);
+    return true;
+}
+
+bool DirectEvaluation::factorize(ModelType * mdl, const vector<int> &policy){
+    //A = I - discount*P for the current policy in CSR format
+    n = mdl->getNumberOfStates();
+    vector<long long> rowOffsets(n + 1, 0);
+    vector<int> cols;
+    vector<double> vals;
+    RowBuffer buf;
+    for (int sidx = 0; sidx < n; sidx++) {
+        int aidx = policy[sidx];
+        TransitionRow row = mdl->getRow(sidx, aidx, buf);
+        cols.push_back(sidx);
+        vals.push_back(1.0);
+        for (int c = 0; c < row.length; c++) {
+            cols.push_back(row.cols[c]);
+            vals.push_back(-discount * row.probs[c]);
+        }
+        rowOffsets[sidx + 1] = cols.size();
+    }
+
+    //the fill-in is limited to 20 times the non-zeros of A (at least 1e7 non-zeros), and the
+    //update rank such that the columns of Z use at most 1e7 doubles
+    long long maxNonZeros = max((long long)1e7, 20 * (long long)cols.size());
+    maxRank = min(64, max(1, (int)(1e7 / n)));
+    basePolicy = policy;
+    updatedStates.clear();
+    updateColumns.clear();
+    factorizations++;
+    return lu.factorize(n, rowOffsets, cols, vals, maxNonZeros);
+}
+
+double DirectEvaluation::rowDifference(ModelType * mdl, int sidx, int aidx, const vector<double> &x, RowBuffer &buf){
+    int aBase = basePolicy[sidx];
+    TransitionRow row = mdl->getRow(sidx, aidx, buf);
+    double sum = 0;
+    for (int c = 0; c < row.length; c++) {
+        sum += row.probs[c] * x[row.cols[c]];
+    }
+    row = mdl->getRow(sidx, aBase, buf);
+    for (int c = 0; c < row.length; c++) {
+        sum -= row.probs[c] * x[row.cols[c]];
+    }
+    return sum;
+}
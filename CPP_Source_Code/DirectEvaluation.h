@@ -0,0 +1,73 @@
+/*
+* MIT License
+*
+* Copyright (c) 2024 Anders Reenberg Andersen and Jesper Fink Andersen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "ModelType.h"
+#include "SparseLU.h"
+#include <vector>
+
+using namespace std;
+
+#ifndef DIRECTEVALUATION_H
+#define DIRECTEVALUATION_H
+
+//Exact policy evaluation, i.e., the solution of (I - discount*P) v = r for the current policy,
+//with a sparse LU factorization. Consecutive policies of PI usually differ in a few states only,
+//so the matrix is only factorized for a base policy, and the rows of the states whose action
+//differs from the base policy are handled as a low-rank update (Sherman-Morrison-Woodbury).
+//The matrix is refactorized for the current policy when the number of updated rows becomes too large.
+class DirectEvaluation {
+public:
+
+    DirectEvaluation(bool parallel = true);
+    DirectEvaluation(const DirectEvaluation& orig);
+    virtual ~DirectEvaluation();
+
+    //METHODS
+    //overwrites v with the values of the policy. Returns false if the factorization
+    //of the matrix would need too much memory, in which case v is unchanged.
+    bool evaluate(ModelType * mdl, const vector<int> &policy, double discount, vector<double> &v);
+    void clear(); //removes the factorization, e.g. when a new model is loaded
+    int getRank(); //number of updated rows in the last evaluation
+    int getFactorizations(); //number of factorizations so far
+
+private:
+
+    //VARIABLES
+    bool parallel;
+    int n;
+    double discount;
+    int maxRank; //refactorize when more rows than this are updated
+    int factorizations;
+    SparseLU lu; //factorization of I - discount*P for basePolicy
+    vector<int> basePolicy;
+    vector<int> updatedStates; //states whose action differs from basePolicy
+    vector<vector<double> > updateColumns; //updateColumns[k] is the solution of A_base z = e_s for s = updatedStates[k]
+
+    //METHODS
+    bool factorize(ModelType * mdl, const vector<int> &policy);
+    double rowDifference(ModelType * mdl, int sidx, int aidx, const vector<double> &x, RowBuffer &buf); //(P_policy - P_base)(sidx,:) x
+
+};
+
+#endif /* DIRECTEVALUATION_H */
@@ -0,0 +1,111 @@
+/*
+* MIT License
+*
+* Copyright (c) 2024 Anders Reenberg Andersen and Jesper Fink Andersen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "EvaluationSchedule.h"
+#include <algorithm>
+#include <math.h>
+
+EvaluationSchedule::EvaluationSchedule():
+    maxLength(1),
+    nStates(1),
+    sweeps(0),
+    contraction(0.9),
+    costRatio(0),
+    changedFraction(1),
+    normFirst(0),
+    normLast(0)
+{
+}
+
+EvaluationSchedule::EvaluationSchedule(const EvaluationSchedule& orig):
+    lengths(orig.lengths),
+    maxLength(orig.maxLength),
+    nStates(orig.nStates),
+    sweeps(orig.sweeps),
+    contraction(orig.contraction),
+    costRatio(orig.costRatio),
+    changedFraction(orig.changedFraction),
+    normFirst(orig.normFirst),
+    normLast(orig.normLast)
+{
+}
+
+EvaluationSchedule::~EvaluationSchedule() {
+}
+
+void EvaluationSchedule::initialize(int maxLen, double discount, int n){
+    maxLength = max(maxLen, 1);
+    nStates = max(n, 1);
+    contraction = discount; //until the contraction of the evaluation sweeps is observed
+    costRatio = 0;
+    changedFraction = 1;
+    lengths.clear();
+}
+
+int EvaluationSchedule::nextLength(){
+    int length;
+    if (lengths.empty()) {
+        length = min(maxLength, 2); //the initial policy is rarely good, and two sweeps show the contraction
+    } else {
+        double eta = max(changedFraction, 1 / (1 + costRatio));
+        eta = min(eta, 0.5);
+        double sweepsNeeded = ceil(log(eta) / log(contraction));
+        length = (int)max(1.0, min((double)maxLength, sweepsNeeded));
+    }
+    lengths.push_back(length);
+    sweeps = 0;
+    evaluationStart = chrono::high_resolution_clock::now();
+    return length;
+}
+
+void EvaluationSchedule::evaluationSweep(double norm){
+    if (sweeps == 0) {
+        normFirst = norm;
+    }
+    normLast = norm;
+    sweeps++;
+}
+
+void EvaluationSchedule::improvementStart(){
+    improvementBegin = chrono::high_resolution_clock::now();
+
+    //geometric mean of the reductions between the sweeps of this evaluation
+    if (sweeps >= 2 && normFirst > 0 && normLast > 0) {
+        double observed = pow(normLast / normFirst, 1.0 / (sweeps - 1));
+        contraction = max(1e-3, min(observed, 1 - 1e-6));
+    }
+}
+
+void EvaluationSchedule::improvementSweep(int polChanges){
+    auto t = chrono::high_resolution_clock::now();
+    changedFraction = (double)polChanges / nStates;
+    if (sweeps > 0) {
+        double evaluationTime = chrono::duration<double>(improvementBegin - evaluationStart).count() / sweeps;
+        double improvementTime = chrono::duration<double>(t - improvementBegin).count();
+        if (evaluationTime > 0) {
+            double ratio = improvementTime / evaluationTime;
+            costRatio = costRatio > 0 ? 0.5 * (costRatio + ratio) : ratio; //smoothed over the iterations
+        }
+    }
+}
@@ -0,0 +1,70 @@
+/*
+* MIT License
+*
+* Copyright (c) 2024 Anders Reenberg Andersen and Jesper Fink Andersen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include <vector>
+#include <chrono>
+
+using namespace std;
+
+#ifndef EVALUATIONSCHEDULE_H
+#define EVALUATIONSCHEDULE_H
+
+//Adaptive partial evaluation limit for modified policy iteration. Each iteration performs m evaluation
+//sweeps followed by one improvement sweep. The evaluation reduces the residual of the current policy by
+//the observed contraction rho per sweep, so m = log(eta)/log(rho) sweeps reduce it by the factor eta.
+//The target eta is large (short evaluation) when many states changed action in the last improvement
+//sweep, since the values of an outdated policy are not worth computing accurately, and small (long
+//evaluation) when the policy is stable or an improvement sweep costs many evaluation sweeps:
+//eta = max(polChanges/nStates, 1/(1 + costRatio)), where costRatio is the measured runtime of an
+//improvement sweep over that of an evaluation sweep. m is limited to [1, maxLength].
+class EvaluationSchedule {
+public:
+
+    EvaluationSchedule();
+    EvaluationSchedule(const EvaluationSchedule& orig);
+    virtual ~EvaluationSchedule();
+
+    //VARIABLES
+    vector<int> lengths; //the partial evaluation limit chosen in each iteration
+
+    //METHODS
+    void initialize(int maxLength, double discount, int nStates);
+    int nextLength(); //limit of the next partial evaluation (starts its timer)
+    void evaluationSweep(double norm); //after each evaluation sweep
+    void improvementStart(); //before the improvement sweep
+    void improvementSweep(int polChanges); //after the improvement sweep
+
+private:
+
+    //VARIABLES
+    int maxLength, nStates, sweeps;
+    double contraction; //observed reduction of the residual per evaluation sweep
+    double costRatio; //runtime of an improvement sweep over that of an evaluation sweep (0 if not measured)
+    double changedFraction; //fraction of the states that changed action in the last improvement sweep
+    double normFirst, normLast; //residuals of the first and last sweep of the current evaluation
+    chrono::high_resolution_clock::time_point evaluationStart, improvementBegin;
+
+};
+
+#endif /* EVALUATIONSCHEDULE_H */
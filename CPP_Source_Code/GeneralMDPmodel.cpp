@@ -27,7 +27,9 @@
 GeneralMDPmodel::GeneralMDPmodel(Rewards * rw, TransitionMatrix * tm, double discount):
 rewards(rw),
 tranMat(tm),
-discount(discount)
+discount(discount),
+singlePrecision(false),
+kernelRows(false)
 {
     initialize();
 }
@@ -41,54 +43,20 @@ GeneralMDPmodel::~GeneralMDPmodel() {
 
 void GeneralMDPmodel::initialize(){
     numberOfStates=tranMat->numberOfRows();
-    cidx=0;
-}
-        
-double GeneralMDPmodel::reward(int &sidx, int &aidx){
-    return rewards->getReward(sidx,aidx);
-}
-
-double GeneralMDPmodel::transProb(int &sidx, int &aidx, int &jidx){
-    //calculates the probability of jumping to state jidx from
-    //the current state sidx when taking action aidx.
-    //returns *and* stores the calculated probability in the variable psj.
-
-    return tranMat->getProb(sidx,aidx,jidx);
 }
 
-int GeneralMDPmodel::getNumberOfJumps(int &sidx, int &aidx){
-    return tranMat->numberOfColumns(sidx,aidx);
+bool GeneralMDPmodel::useSinglePrecision(bool single){
+    //the copy is created by the owner of the transition matrix (see TransitionMatrix::computeSinglePrecision)
+    singlePrecision = single && tranMat->hasSinglePrecision();
+    return singlePrecision == single;
 }
 
-void GeneralMDPmodel::updateNextState(int &sidx, int &aidx, int &jidx){
-    //updates the next possible state, nextState, and the associated
-    //transition probability, psj.    
-    while (tranMat->getColumn(sidx,aidx,cidx)!=jidx){ //this will in many cases immediately evaluate to False
-        cidx++;
-        if (cidx==tranMat->numberOfColumns(sidx,aidx)){ //to make sure cidx is always feasible
-            cidx=0;
-        }    
-    }
-    cidx++; //move one additional step
-    if (cidx==tranMat->numberOfColumns(sidx,aidx)){
-        cidx=0;
-    }
-    nextState = tranMat->getColumn(sidx,aidx,cidx);
-    psj = tranMat->getProb(sidx,aidx,cidx);
-}    
-
-int GeneralMDPmodel::getColumnIdx(int &sidx, int &aidx, int &cidx){
-    return tranMat->getColumn(sidx,aidx,cidx);
+double GeneralMDPmodel::singlePrecisionError(){
+    return tranMat->singlePrecisionError();
 }
 
-int GeneralMDPmodel::postDecisionIdx(int &sidx, int &aidx){
-    //derives the first new/next state that is possible
-    //to reach from the current state sidx.
-    //both returns the value of the first new state, and
-    //stores it in the variable nextState.
-    cidx=0;
-    nextState = tranMat->getColumn(sidx,aidx,cidx);
-    return nextState;
+void GeneralMDPmodel::useKernelRows(bool kernelOnly){
+    kernelRows = kernelOnly;
 }
 
 double GeneralMDPmodel::getDiscount(){
@@ -97,24 +65,4 @@ double GeneralMDPmodel::getDiscount(){
 
 int GeneralMDPmodel::getNumberOfStates(){
     return numberOfStates;
-}
-
-void GeneralMDPmodel::updateNumberOfActions(int &sidx){
-    numberOfActions=tranMat->numberOfActions(sidx);
-}
-
-int GeneralMDPmodel::getNumberOfActions(){
-    return numberOfActions;
-}
-
-int GeneralMDPmodel::getNumberOfActions(int &sidx){
-    return tranMat->numberOfActions(sidx);
-}
-
-int * GeneralMDPmodel::getNextState(){
-    return &nextState;
-}
-
-double GeneralMDPmodel::getPsj(){
-    return psj;
-}
+}
\ No newline at end of file
@@ -34,7 +34,7 @@
 
 using namespace std;
 
-class GeneralMDPmodel : public ModelType{
+class GeneralMDPmodel final : public ModelType{
 public:
     
     //CONSTRUCTOR AND DESCTRUCTOR
@@ -47,38 +47,75 @@ public:
     //VARIABLES
 
     double discount;
-	int numberOfStates, numberOfActions;
-    
-    //auxiliary variables
-    int nextState; //a new state that the current state can jump to
-    double psj; //transition probability from the current state to nextState
+	int numberOfStates;
 	
     //METHODS
     void initialize();
         
     //GENERIC METHODS    
     double reward(int &sidx, int &aidx) override;
-    double transProb(int &sidx, int &aidx, int &jidx) override;
-    void updateNextState(int &sidx, int &aidx, int &jidx) override;
-    int postDecisionIdx(int &sidx, int &aidx) override;
-    int getNumberOfJumps(int &sidx, int &aidx) override;
-    int getColumnIdx(int &sidx, int &aidx, int &cidx) override;
+    TransitionRow getRow(int &sidx, int &aidx, RowBuffer &buf) override;
     double getDiscount() override;
     int getNumberOfStates() override;
-    void updateNumberOfActions(int &sidx) override;
-    int getNumberOfActions() override;
     int getNumberOfActions(int &sidx) override;
-    int * getNextState() override;
-    double getPsj() override;
+    bool useSinglePrecision(bool single) override;
+    double singlePrecisionError() override;
+    void useKernelRows(bool kernelOnly) override;
 
 private:
 
     //VARIABLES
     Rewards * rewards;
     TransitionMatrix * tranMat;
-    int cidx;
+    bool singlePrecision; //rows are read from the single-precision copy of the probabilities
+    bool kernelRows; //compressed rows are returned without decoding their columns
     
 
 };
 
+//accessors used in the inner loops of the solver are defined
+//here so that the compiler can inline them into the solver kernels
+
+inline double GeneralMDPmodel::reward(int &sidx, int &aidx){
+    return rewards->getReward(sidx,aidx);
+}
+
+inline TransitionRow GeneralMDPmodel::getRow(int &sidx, int &aidx, RowBuffer &buf){
+    //the row is read directly from the CSR storage. buf is only used for the decoded columns of compressed rows
+    TransitionRow row;
+    if (singlePrecision) {
+        row.probs = NULL;
+        row.probsSingle = tranMat->getRowProbsSingle(sidx,aidx);
+    } else {
+        row.probs = tranMat->getRowProbs(sidx,aidx);
+        row.probsSingle = NULL;
+    }
+    row.length = tranMat->numberOfColumns(sidx,aidx);
+    int base = tranMat->getRowColumnBase(sidx,aidx);
+    if (base < 0) {
+        row.cols = tranMat->getRowColumns(sidx,aidx);
+        row.colDeltas = NULL;
+        row.colBase = 0;
+    } else if (kernelRows) {
+        row.cols = NULL;
+        row.colDeltas = tranMat->getRowColumnDeltas(sidx,aidx);
+        row.colBase = base;
+    } else {
+        //the columns are decoded into buf
+        const unsigned short * deltas = tranMat->getRowColumnDeltas(sidx,aidx);
+        buf.cols.resize(row.length);
+        for (int cidx = 0; cidx < row.length; cidx++) {
+            buf.cols[cidx] = base + deltas[cidx];
+        }
+        row.cols = buf.cols.data();
+        row.colDeltas = NULL;
+        row.colBase = 0;
+    }
+    return row;
+}
+
+inline int GeneralMDPmodel::getNumberOfActions(int &sidx){
+    return tranMat->numberOfActions(sidx);
+}
+
 #endif /* TBMMODEL_H */
@@ -0,0 +1,244 @@
+/*
+* MIT License
+*
+* Copyright (c) 2024 Anders Reenberg Andersen and Jesper Fink Andersen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "KrylovSolver.h"
+#include <algorithm>
+#include <math.h>
+#include <omp.h>
+
+KrylovSolver::KrylovSolver(string method, int restart, bool parallel):
+    method(method),
+    restart(restart),
+    parallel(parallel),
+    residual(0.0)
+{
+}
+
+KrylovSolver::KrylovSolver(const KrylovSolver& orig):
+    method(orig.method),
+    restart(orig.restart),
+    parallel(orig.parallel),
+    residual(orig.residual)
+{
+}
+
+KrylovSolver::~KrylovSolver() {
+}
+
+int KrylovSolver::solve(const function<void(const vector<double>&, vector<double>&)> &matVec,
+    const vector<double> &b, vector<double> &x, double tolerance, int maxMatVecs){
+    if (method.compare("bicgstab") == 0) {
+        return bicgstab(matVec, b, x, tolerance, maxMatVecs);
+    } else {
+        return gmres(matVec, b, x, tolerance, maxMatVecs);
+    }
+}
+
+double KrylovSolver::getResidual(){
+    return residual;
+}
+
+string KrylovSolver::getMethod(){
+    return method;
+}
+
+int KrylovSolver::gmres(const function<void(const vector<double>&, vector<double>&)> &matVec,
+    const vector<double> &b, vector<double> &x, double tolerance, int maxMatVecs){
+    //restarted GMRES with modified Gram-Schmidt and Givens rotations (Saad, Algorithm 6.9)
+    int n = b.size();
+    int matVecs = 0;
+    vector<vector<double>> V(restart + 1, vector<double>(n)); //Krylov basis
+    vector<double> H((restart + 1) * restart); //Hessenberg matrix, H[i*restart+j] is element (i,j)
+    vector<double> cs(restart), sn(restart), g(restart + 1), y(restart);
+    vector<double> w(n);
+
+    while (true) {
+        //residual of the current x
+        matVec(x, w);
+        matVecs++;
+        #pragma omp parallel for if(parallel)
+        for (int i = 0; i < n; i++) {
+            V[0][i] = b[i] - w[i];
+        }
+        double beta = norm(V[0]);
+        residual = beta;
+        if (beta <= tolerance || matVecs >= maxMatVecs) {
+            break;
+        }
+        scale(1.0 / beta, V[0]);
+        fill(g.begin(), g.end(), 0.0);
+        g[0] = beta;
+
+        //Arnoldi process
+        int k = 0; //dimension of the Krylov subspace
+        while (k < restart && matVecs < maxMatVecs) {
+            int j = k;
+            matVec(V[j], w);
+            matVecs++;
+            for (int i = 0; i <= j; i++) {
+                H[i * restart + j] = dot(w, V[i]);
+                axpy(-H[i * restart + j], V[i], w);
+            }
+            double hNext = norm(w);
+            H[(j + 1) * restart + j] = hNext;
+            if (hNext > 0) {
+                #pragma omp parallel for if(parallel)
+                for (int i = 0; i < n; i++) {
+                    V[j + 1][i] = w[i] / hNext;
+                }
+            }
+
+            //apply the previous rotations to the new column, and eliminate H(j+1,j)
+            for (int i = 0; i < j; i++) {
+                double temp = cs[i] * H[i * restart + j] + sn[i] * H[(i + 1) * restart + j];
+                H[(i + 1) * restart + j] = -sn[i] * H[i * restart + j] + cs[i] * H[(i + 1) * restart + j];
+                H[i * restart + j] = temp;
+            }
+            double denom = sqrt(H[j * restart + j] * H[j * restart + j] + hNext * hNext);
+            cs[j] = H[j * restart + j] / denom;
+            sn[j] = hNext / denom;
+            H[j * restart + j] = denom;
+            H[(j + 1) * restart + j] = 0;
+            g[j + 1] = -sn[j] * g[j];
+            g[j] = cs[j] * g[j];
+            k++;
+
+            residual = fabs(g[k]);
+            if (residual <= tolerance || hNext == 0) {
+                break;
+            }
+        }
+
+        //x += V*y, where y solves the upper triangular system H y = g
+        for (int i = k - 1; i >= 0; i--) {
+            y[i] = g[i];
+            for (int l = i + 1; l < k; l++) {
+                y[i] -= H[i * restart + l] * y[l];
+            }
+            y[i] /= H[i * restart + i];
+        }
+        #pragma omp parallel for if(parallel)
+        for (int i = 0; i < n; i++) {
+            double sum = 0;
+            for (int l = 0; l < k; l++) {
+                sum += y[l] * V[l][i];
+            }
+            x[i] += sum;
+        }
+
+        if (residual <= tolerance || matVecs >= maxMatVecs) {
+            break;
+        }
+    }
+    return matVecs;
+}
+
+int KrylovSolver::bicgstab(const function<void(const vector<double>&, vector<double>&)> &matVec,
+    const vector<double> &b, vector<double> &x, double tolerance, int maxMatVecs){
+    //BiCGSTAB (van der Vorst, 1992)
+    int n = b.size();
+    int matVecs = 0;
+    vector<double> r(n), rHat(n), p(n, 0.0), v(n, 0.0), s(n), t(n);
+
+    matVec(x, r);
+    matVecs++;
+    #pragma omp parallel for if(parallel)
+    for (int i = 0; i < n; i++) {
+        r[i] = b[i] - r[i];
+    }
+    rHat = r;
+    residual = norm(r);
+    double rho = 1, alpha = 1, omega = 1;
+
+    while (residual > tolerance && matVecs < maxMatVecs) {
+        double rhoNew = dot(rHat, r);
+        if (rhoNew == 0) {
+            //breakdown: restart with the current residual as shadow residual
+            rHat = r;
+            rhoNew = dot(rHat, r);
+            fill(p.begin(), p.end(), 0.0);
+            fill(v.begin(), v.end(), 0.0);
+            rho = alpha = omega = 1;
+        }
+        double beta = (rhoNew / rho) * (alpha / omega);
+        #pragma omp parallel for if(parallel)
+        for (int i = 0; i < n; i++) {
+            p[i] = r[i] + beta * (p[i] - omega * v[i]);
+        }
+        matVec(p, v);
+        matVecs++;
+        alpha = rhoNew / dot(rHat, v);
+        #pragma omp parallel for if(parallel)
+        for (int i = 0; i < n; i++) {
+            s[i] = r[i] - alpha * v[i];
+        }
+        double sNorm = norm(s);
+        if (sNorm <= tolerance || matVecs >= maxMatVecs) {
+            axpy(alpha, p, x);
+            residual = sNorm;
+            break;
+        }
+        matVec(s, t);
+        matVecs++;
+        omega = dot(t, s) / dot(t, t);
+        #pragma omp parallel for if(parallel)
+        for (int i = 0; i < n; i++) {
+            x[i] += alpha * p[i] + omega * s[i];
+            r[i] = s[i] - omega * t[i];
+        }
+        residual = norm(r);
+        rho = rhoNew;
+    }
+    return matVecs;
+}
+
+double KrylovSolver::dot(const vector<double> &x, const vector<double> &y){
+    int n = x.size();
+    double sum = 0;
+    #pragma omp parallel for reduction(+:sum) if(parallel)
+    for (int i = 0; i < n; i++) {
+        sum += x[i] * y[i];
+    }
+    return sum;
+}
+
+double KrylovSolver::norm(const vector<double> &x){
+    return sqrt(dot(x, x));
+}
+
+void KrylovSolver::axpy(double a, const vector<double> &x, vector<double> &y){
+    int n = x.size();
+    #pragma omp parallel for if(parallel)
+    for (int i = 0; i < n; i++) {
+        y[i] += a * x[i];
+    }
+}
+
+void KrylovSolver::scale(double a, vector<double> &x){
+    int n = x.size();
+    #pragma omp parallel for if(parallel)
+    for (int i = 0; i < n; i++) {
+        x[i] *= a;
+    }
+}
@@ -0,0 +1,76 @@
+/*
+* MIT License
+*
+* Copyright (c) 2024 Anders Reenberg Andersen and Jesper Fink Andersen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include <vector>
+#include <string>
+#include <functional>
+
+using namespace std;
+
+#ifndef KRYLOVSOLVER_H
+#define KRYLOVSOLVER_H
+
+//Matrix-free Krylov methods (restarted GMRES and BiCGSTAB) for the linear system A x = b.
+//The matrix is only accessed through a function computing y = A x, such that the solver
+//can be used with any model type. Used for the policy evaluation in PI and MPI, where
+//A = I - discount * P_policy and b = r_policy.
+class KrylovSolver {
+public:
+
+    KrylovSolver(string method = "gmres", int restart = 20, bool parallel = true);
+    KrylovSolver(const KrylovSolver& orig);
+    virtual ~KrylovSolver();
+
+    //METHODS
+    //solves A x = b, where x holds the initial guess on entry. Stops when the residual
+    //||b - A x||_2 is at most tolerance or after maxMatVecs products with A.
+    //Returns the number of products with A.
+    int solve(const function<void(const vector<double>&, vector<double>&)> &matVec,
+        const vector<double> &b, vector<double> &x, double tolerance, int maxMatVecs);
+    double getResidual(); //residual norm when the last solve stopped
+    string getMethod();
+
+private:
+
+    //VARIABLES
+    string method;
+    int restart; //GMRES restart length
+    bool parallel;
+    double residual;
+
+    //METHODS
+    int gmres(const function<void(const vector<double>&, vector<double>&)> &matVec,
+        const vector<double> &b, vector<double> &x, double tolerance, int maxMatVecs);
+    int bicgstab(const function<void(const vector<double>&, vector<double>&)> &matVec,
+        const vector<double> &b, vector<double> &x, double tolerance, int maxMatVecs);
+
+    //vector operations
+    double dot(const vector<double> &x, const vector<double> &y);
+    double norm(const vector<double> &x);
+    void axpy(double a, const vector<double> &x, vector<double> &y); //y += a*x
+    void scale(double a, vector<double> &x); //x *= a
+
+};
+
+#endif /* KRYLOVSOLVER_H */
@@ -0,0 +1,62 @@
+/*
+* MIT License
+*
+* Copyright (c) 2024 Anders Reenberg Andersen and Jesper Fink Andersen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include <string>
+#include <cstddef>
+
+using namespace std;
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+//Read-only memory mapping of a file (mmap, or MapViewOfFile on Windows). The pages of the file
+//are read by the operating system when they are first accessed.
+class MappedFile {
+public:
+
+    MappedFile();
+    MappedFile(const MappedFile& orig) = delete; //the mapping is unmapped by the destructor
+    MappedFile& operator=(const MappedFile& orig) = delete;
+    virtual ~MappedFile();
+
+    //METHODS
+    bool open(string fileName); //maps the file. Prints an error and returns false if it is missing or empty.
+    void close();
+    bool isOpen();
+    const char * data(); //first byte of the file (NULL if no file is open)
+    size_t size(); //bytes in the file
+
+private:
+
+    //VARIABLES
+    const char * start;
+    size_t length;
+    #ifdef _WIN32
+    void * fileHandle;
+    void * mappingHandle;
+    #endif
+
+};
+
+#endif /* MAPPEDFILE_H */
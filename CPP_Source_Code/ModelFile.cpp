@@ -0,0 +1,286 @@
+/*
+* MIT License
+*
+* Copyright (c) 2024 Anders Reenberg Andersen and Jesper Fink Andersen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "ModelFile.h"
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <climits>
+
+static const char modelFileMagic[8] = {'M','D','P','S','L','V','R','1'};
+static const unsigned int modelFileVersion = 1;
+static const unsigned int modelFileByteOrder = 0x01020304;
+static const long long sectionAlignment = 64; //sections start on cache lines
+
+static long long alignSection(long long offset){
+    return (offset + sectionAlignment - 1) / sectionAlignment * sectionAlignment;
+}
+
+ModelFile::ModelFile():
+    tranMat(NULL),
+    rewards(NULL)
+{
+}
+
+ModelFile::~ModelFile() {
+    close();
+}
+
+void ModelFile::sectionSizes(const Header &header, long long sizes[numberOfSections]){
+    bool compressed = header.flags & 1;
+    sizes[ACTION_OFFSETS] = 4 * (header.nStates + 1);
+    sizes[ROW_OFFSETS] = 8 * (header.nRows + 1);
+    sizes[PROBS] = 8 * header.nnz;
+    sizes[COLS] = compressed ? 0 : 4 * header.nnz;
+    sizes[COLUMN_BASE] = compressed ? 4 * header.nRows : 0;
+    sizes[COLUMN_DELTAS] = compressed ? 2 * header.nnz : 0;
+    sizes[WIDE_OFFSETS] = compressed ? 8 * header.nWide : 0;
+    sizes[WIDE_COLS] = compressed ? 4 * header.wideNnz : 0;
+    sizes[REWARDS] = 8 * header.nRows;
+}
+
+string ModelFile::validContents(const Header &header, const char * data){
+    //the solver does not check indices, so a corrupt file must not get that far
+    const int * actionOffsets = (const int *)(data + header.sections[ACTION_OFFSETS]);
+    const long long * rowOffsets = (const long long *)(data + header.sections[ROW_OFFSETS]);
+    long long nStates = header.nStates;
+    long long nRows = header.nRows;
+    if (actionOffsets[0] != 0 || actionOffsets[nStates] != nRows || rowOffsets[0] != 0 || rowOffsets[nRows] != header.nnz) {
+        return "The offsets in the model file are invalid.";
+    }
+    bool valid = true;
+    #pragma omp parallel for reduction(&&:valid)
+    for (long long sidx = 0; sidx < nStates; sidx++) {
+        valid = valid && actionOffsets[sidx] < actionOffsets[sidx + 1]; //each state has an action
+    }
+    #pragma omp parallel for reduction(&&:valid)
+    for (long long k = 0; k < nRows; k++) {
+        valid = valid && rowOffsets[k] <= rowOffsets[k + 1];
+    }
+    if (!valid) {
+        return "The offsets in the model file are invalid.";
+    }
+
+    if (!(header.flags & 1)) {
+        const int * cols = (const int *)(data + header.sections[COLS]);
+        #pragma omp parallel for reduction(&&:valid)
+        for (long long j = 0; j < header.nnz; j++) {
+            valid = valid && cols[j] >= 0 && cols[j] < nStates;
+        }
+    } else {
+        const int * columnBase = (const int *)(data + header.sections[COLUMN_BASE]);
+        const unsigned short * columnDeltas = (const unsigned short *)(data + header.sections[COLUMN_DELTAS]);
+        const long long * wideOffsets = (const long long *)(data + header.sections[WIDE_OFFSETS]);
+        const int * wideCols = (const int *)(data + header.sections[WIDE_COLS]);
+        #pragma omp parallel for reduction(&&:valid)
+        for (long long k = 0; k < nRows; k++) {
+            long long w = -(long long)columnBase[k] - 1; //full row if columnBase[k] < 0
+            valid = valid && (w < 0 || (w < header.nWide && wideOffsets[w] >= 0
+                && wideOffsets[w] <= header.wideNnz - (rowOffsets[k + 1] - rowOffsets[k])));
+        }
+        if (!valid) {
+            return "The offsets in the model file are invalid.";
+        }
+        #pragma omp parallel for reduction(&&:valid)
+        for (long long k = 0; k < nRows; k++) {
+            long long base = columnBase[k];
+            for (long long j = rowOffsets[k]; j < rowOffsets[k + 1] && base >= 0 && valid; j++) {
+                valid = base + columnDeltas[j] < nStates;
+            }
+        }
+        #pragma omp parallel for reduction(&&:valid)
+        for (long long j = 0; j < header.wideNnz; j++) {
+            valid = valid && wideCols[j] >= 0 && wideCols[j] < nStates;
+        }
+    }
+    if (!valid) {
+        return "The model file contains a column index that is negative or not smaller than the number of states.";
+    }
+    return "";
+}
+
+bool ModelFile::write(string fileName, TransitionMatrix &tranMat, Rewards &rewards){
+    const TransitionMatrix::View &view = tranMat.view;
+    if (view.nStates == 0 || rewards.numberOfRows() != view.nStates) {
+        cerr << "Error: The rewards and the transition probabilities must be defined for the same states." << endl;
+        return false;
+    }
+    for (int sidx = 0; sidx < view.nStates; sidx++) {
+        if (rewards.numberOfActions(sidx) != tranMat.numberOfActions(sidx)) {
+            cerr << "Error: The rewards and the transition probabilities have a different number of actions in state " << sidx << "." << endl;
+            return false;
+        }
+    }
+
+    Header header;
+    memset(&header, 0, sizeof(Header));
+    memcpy(header.magic, modelFileMagic, sizeof(header.magic));
+    header.version = modelFileVersion;
+    header.byteOrder = modelFileByteOrder;
+    header.nStates = view.nStates;
+    header.nRows = view.nRows;
+    header.nnz = view.nnz;
+    if (view.columnBase != NULL) {
+        header.flags = 1;
+        for (long long k = 0; k < view.nRows; k++) {
+            if (view.columnBase[k] < 0) {
+                header.nWide++;
+                header.wideNnz += view.rowOffsets[k + 1] - view.rowOffsets[k];
+            }
+        }
+    }
+
+    //the rewards are stored row by row with the same action offsets as the transition probabilities
+    const void * contents[numberOfSections] = {view.actionOffsets, view.rowOffsets, view.probs, view.cols,
+        view.columnBase, view.columnDeltas, view.wideOffsets, view.wideCols, rewards.rewardsView};
+    long long sizes[numberOfSections];
+    sectionSizes(header, sizes);
+    long long offset = alignSection(sizeof(Header));
+    for (int i = 0; i < numberOfSections; i++) {
+        if (sizes[i] > 0) {
+            header.sections[i] = offset;
+            offset = alignSection(offset + sizes[i]);
+        }
+    }
+
+    ofstream file(fileName, ios::binary | ios::trunc);
+    if (!file.is_open()) {
+        cerr << "Error: Unable to open " << fileName << endl;
+        return false;
+    }
+    file.write((const char *)&header, sizeof(Header));
+    long long position = sizeof(Header);
+    const char padding[sectionAlignment] = {0};
+    for (int i = 0; i < numberOfSections; i++) {
+        if (sizes[i] > 0) {
+            file.write(padding, header.sections[i] - position);
+            file.write((const char *)contents[i], sizes[i]);
+            position = header.sections[i] + sizes[i];
+        }
+    }
+    file.close();
+    if (file.fail()) {
+        cerr << "Error: Unable to write " << fileName << endl;
+        return false;
+    }
+    return true;
+}
+
+bool ModelFile::open(string fileName, TransitionMatrix &tranMat, Rewards &rewards){
+    close();
+    if (!file.open(fileName)) {
+        return false;
+    }
+    const char * data = file.data();
+    size_t size = file.size();
+
+    //check the header and that the sections are within the file
+    Header header;
+    string error;
+    long long sizes[numberOfSections];
+    if (size < sizeof(Header)) {
+        error = "The file is too short.";
+    } else {
+        memcpy(&header, data, sizeof(Header));
+        if (memcmp(header.magic, modelFileMagic, sizeof(header.magic)) != 0) {
+            error = "The file is not a model file.";
+        } else if (header.version != modelFileVersion) {
+            error = "The version of the model file is not supported.";
+        } else if (header.byteOrder != modelFileByteOrder) {
+            error = "The model file was written on a machine with a different byte order.";
+        } else if (header.nStates <= 0 || header.nStates >= INT_MAX || header.nRows < header.nStates || header.nRows >= INT_MAX
+            || header.nnz < 0 || header.nWide < 0 || header.nWide > header.nRows || header.wideNnz < 0 || header.wideNnz > header.nnz) {
+            error = "The header of the model file is invalid.";
+        } else if (header.nRows > (long long)(size / 8) || header.nnz > (long long)(size / 8)
+            || header.nWide > (long long)(size / 8) || header.wideNnz > (long long)(size / 4)) {
+            error = "The model file is truncated or invalid."; //the section sizes below would overflow
+        } else {
+            sectionSizes(header, sizes);
+        }
+        for (int i = 0; i < numberOfSections && error.empty(); i++) {
+            if (sizes[i] > 0 && (header.sections[i] <= 0 || header.sections[i] % sectionAlignment != 0
+                || header.sections[i] > (long long)size || sizes[i] > (long long)size - header.sections[i])) {
+                error = "The model file is truncated or invalid.";
+            }
+        }
+    }
+    if (error.empty()) {
+        error = validContents(header, data);
+    }
+    if (!error.empty()) {
+        cerr << "Error: " << error << " (" << fileName << ")" << endl;
+        file.close();
+        return false;
+    }
+
+    //release the current model and point the views to the mapped sections
+    tranMat.setNumberOfRows(0);
+    rewards.setNumberOfRows(0);
+    TransitionMatrix::View &view = tranMat.view;
+    view.nStates = header.nStates;
+    view.nRows = header.nRows;
+    view.nnz = header.nnz;
+    view.actionOffsets = (const int *)(data + header.sections[ACTION_OFFSETS]);
+    view.rowOffsets = (const long long *)(data + header.sections[ROW_OFFSETS]);
+    view.probs = (const double *)(data + header.sections[PROBS]);
+    if (header.flags & 1) {
+        view.cols = NULL;
+        view.columnBase = (const int *)(data + header.sections[COLUMN_BASE]);
+        view.columnDeltas = (const unsigned short *)(data + header.sections[COLUMN_DELTAS]);
+        view.wideOffsets = (const long long *)(data + header.sections[WIDE_OFFSETS]);
+        view.wideCols = (const int *)(data + header.sections[WIDE_COLS]);
+    } else {
+        view.cols = (const int *)(data + header.sections[COLS]);
+        view.columnBase = NULL;
+        view.columnDeltas = NULL;
+        view.wideOffsets = NULL;
+        view.wideCols = NULL;
+    }
+    tranMat.external = true;
+    rewards.nStates = header.nStates;
+    rewards.actionOffsetsView = view.actionOffsets;
+    rewards.rewardsView = (const double *)(data + header.sections[REWARDS]);
+    rewards.external = true;
+    this->tranMat = &tranMat;
+    this->rewards = &rewards;
+    return true;
+}
+
+void ModelFile::close(){
+    if (tranMat != NULL) {
+        tranMat->external = false;
+        tranMat->updateView();
+        tranMat = NULL;
+    }
+    if (rewards != NULL) {
+        rewards->external = false;
+        rewards->updateView();
+        rewards = NULL;
+    }
+    file.close();
+}
+
+bool ModelFile::isOpen(){
+    return file.isOpen();
+}
@@ -0,0 +1,104 @@
+/*
+* MIT License
+*
+* Copyright (c) 2024 Anders Reenberg Andersen and Jesper Fink Andersen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "TransitionMatrix.h"
+#include "Rewards.h"
+#include "MappedFile.h"
+#include <string>
+
+using namespace std;
+
+#ifndef MODELFILE_H
+#define MODELFILE_H
+
+//Binary model file, which is mapped into memory so that the transition matrix and the rewards are read
+//directly from the pages of the file. The file is not parsed or copied, and the operating system only
+//reads the pages that are used and can drop them again under memory pressure. The offsets and column
+//indices are checked once when the file is opened.
+//
+//Format (native byte order, version 1):
+//  header (136 bytes):
+//    char magic[8]            "MDPSLVR1"
+//    uint32 version           1
+//    uint32 byteOrder         0x01020304 as written by the machine that wrote the file
+//    int64 nStates            number of states
+//    int64 nRows              number of (state,action) rows
+//    int64 nnz                number of non-zero transition probabilities
+//    int64 nWide              number of full rows if the columns are compressed, otherwise 0
+//    int64 wideNnz            number of column indices in the full rows
+//    int64 flags              bit 0: the columns are compressed
+//    int64 sections[numberOfSections]   byte offset of each section (0 if absent), in the order of Section
+//  sections, each starting at a multiple of 64 bytes:
+//    actionOffsets  int32[nStates+1]   first row of each state
+//    rowOffsets     int64[nRows+1]     first non-zero of each row
+//    probs          float64[nnz]       non-zero probabilities
+//    cols           int32[nnz]         column (next state) of each non-zero (only if not compressed)
+//    columnBase     int32[nRows]       see TransitionMatrix::compressColumns (only if compressed)
+//    columnDeltas   uint16[nnz]        (only if compressed)
+//    wideOffsets    int64[nWide]       (only if compressed)
+//    wideCols       int32[wideNnz]     (only if compressed)
+//    rewards        float64[nRows]     reward of each row
+class ModelFile {
+public:
+
+    ModelFile();
+    ModelFile(const ModelFile& orig) = delete; //the mapping is unmapped by the destructor
+    ModelFile& operator=(const ModelFile& orig) = delete;
+    virtual ~ModelFile();
+
+    //METHODS
+    static bool write(string fileName, TransitionMatrix &tranMat, Rewards &rewards); //saves the model in the binary format
+    bool open(string fileName, TransitionMatrix &tranMat, Rewards &rewards); //maps the file and points tranMat and rewards to it
+    void close(); //unmaps the file. tranMat and rewards are left empty.
+    bool isOpen();
+
+private:
+
+    enum Section {ACTION_OFFSETS, ROW_OFFSETS, PROBS, COLS, COLUMN_BASE, COLUMN_DELTAS, WIDE_OFFSETS, WIDE_COLS, REWARDS, numberOfSections};
+
+    struct Header {
+        char magic[8];
+        unsigned int version;
+        unsigned int byteOrder;
+        long long nStates;
+        long long nRows;
+        long long nnz;
+        long long nWide;
+        long long wideNnz;
+        long long flags;
+        long long sections[numberOfSections];
+    };
+
+    //VARIABLES
+    MappedFile file;
+    TransitionMatrix * tranMat;
+    Rewards * rewards;
+
+    //METHODS
+    static void sectionSizes(const Header &header, long long sizes[numberOfSections]); //bytes of each section
+    static string validContents(const Header &header, const char * data); //error message if the offsets or columns are invalid
+
+};
+
+#endif /* MODELFILE_H */
@@ -1,23 +1,48 @@
 #ifndef MODELTYPE_H
 #define MODELTYPE_H
 
+#include <vector>
+
+using namespace std;
+
+//one row of the transition matrix, i.e., the possible next states (cols) and their
+//probabilities (probs) when taking action aidx in state sidx. Models that store a
+//single-precision copy of the probabilities set probsSingle instead of probs when it is in use,
+//and models with compressed column indices set colDeltas and colBase instead of cols for the
+//row kernels (see useKernelRows).
+struct TransitionRow {
+    const double * probs;
+    const float * probsSingle; //NULL unless the probabilities are read in single precision
+    const int * cols;
+    const unsigned short * colDeltas; //NULL unless the columns are colBase + colDeltas[c]
+    int colBase; //0 unless colDeltas is used
+    int length;
+};
+
+//storage provided by the caller for models that generate their rows on demand.
+//the solver keeps one buffer per thread, so getRow must not store anything in the model itself.
+struct RowBuffer {
+    vector<double> probs;
+    vector<int> cols;
+    vector<double> aux; //model-specific scratch space
+};
+
 class ModelType {
 public:
-    
+
     virtual double getDiscount() = 0;
     virtual int getNumberOfStates() = 0;
-    virtual void updateNumberOfActions(int &sidx) = 0;
-    virtual int getNumberOfActions() = 0;
     virtual int getNumberOfActions(int &sidx) = 0;
-    virtual int * getNextState() = 0;
-    virtual double getPsj() = 0;
     virtual double reward(int &sidx, int &aidx) = 0;
-    virtual double transProb(int &sidx, int &aidx, int &jidx) = 0;
-    virtual void updateNextState(int &sidx, int &aidx, int &jidx) = 0;
-    virtual int postDecisionIdx(int &sidx, int &aidx) = 0;
-    virtual int getColumnIdx(int &sidx, int &aidx, int &cidx) = 0;
-    virtual int getNumberOfJumps(int &sidx, int &aidx) = 0;
-    
+    virtual TransitionRow getRow(int &sidx, int &aidx, RowBuffer &buf) = 0;
+    //switches getRow to single-precision probabilities (only the row kernels read them).
+    //returns false if the model has no single-precision copy.
+    virtual bool useSinglePrecision(bool single) { return !single; }
+    virtual double singlePrecisionError() { return 0; } //largest change of a row sum by the rounding
+    //allows getRow to return compressed column indices, which only the row kernels read.
+    //otherwise the rows always have cols.
+    virtual void useKernelRows(bool) {}
+
 };
 
-#endif  // MODELTYPE_H
\ No newline at end of file
+#endif  // MODELTYPE_H
@@ -24,18 +24,23 @@
 
 
 #include "ModifiedPolicyIteration.h"
+#include "GeneralMDPmodel.h"
+#include "NumaPlacement.h"
 #include <iostream>
 #include <omp.h>
 #include <chrono>
+#include <thread>
 #include <string>
 #include <math.h>
+#include <algorithm>
 #include <assert.h> //to verify "algorithm" and "update" input
 
 using namespace std;
 
 
 ModifiedPolicyIteration::ModifiedPolicyIteration(double epsilon, string algorithm, string update, string criterion,
- int parIterLim, double SORrelaxation, bool verbose, bool postProcessing, bool makeFinalCheck, bool parallel, bool genMDP):
+ int parIterLim, double SORrelaxation, bool verbose, bool postProcessing, bool makeFinalCheck, bool parallel, bool genMDP,
+ string evaluation, bool decompose, int andersonDepth, bool adaptiveParIter, bool adaptiveSOR, bool workStealing, bool mixedPrecision, bool actionElimination):
 	epsilon(epsilon),
 	useMPI(algorithm.compare("mpi") == 0),
 	usePI(algorithm.compare("pi") == 0),
@@ -45,11 +50,23 @@ ModifiedPolicyIteration::ModifiedPolicyIteration(double epsilon, string algorith
 	useAvg(criterion.compare("average") == 0),
 	useGS(update.compare("gs") == 0),
 	useSOR(update.compare("sor") == 0),
+	useAsync(update.compare("async") == 0),
+	usePrioritized(update.compare("prioritized") == 0),
+	useLinear(evaluation.compare("gmres") == 0 || evaluation.compare("bicgstab") == 0 || evaluation.compare("direct") == 0),
+	useDirect(evaluation.compare("direct") == 0),
+	useElimination(actionElimination),
+	useDecomposition(decompose),
+	useAdaptive(adaptiveParIter),
+	useAdaptiveSOR(adaptiveSOR),
+	guardSOR(false),
+	useWorkStealing(workStealing),
 	parIterLim(parIterLim), //partial evaluation iteration limit in MPI
 	SORrelaxation(SORrelaxation),
 	//others
 	iterLim((int)1e6), //iteration limit
+	andersonDepth(andersonDepth),
 	PIparIterLim((int)1e6), //iteration limit for policy evaluation in PI
+	useMixed(mixedPrecision),
 	initPol(false),
 	initVal(false),
 	parallel(parallel),
@@ -59,11 +76,20 @@ ModifiedPolicyIteration::ModifiedPolicyIteration(double epsilon, string algorith
 	makeFinalCheck(makeFinalCheck),
 	duration(0.0),
 	converged(false),
-	parIter(0)
+	finalRelaxation(SORrelaxation),
+	singleIterations(0),
+	roundingNoise(0),
+	parIter(0),
+	coloring(NULL),
+	graph(NULL),
+	partition(NULL),
+	krylov(evaluation.compare("bicgstab") == 0 ? "bicgstab" : "gmres", 20, parallel),
+	direct(parallel)
 {
 	//check valid string input
-	assert(update.compare("standard")==0 || update.compare("gs")==0 || update.compare("sor")==0);
+	assert(update.compare("standard")==0 || update.compare("gs")==0 || update.compare("sor")==0 || update.compare("async")==0 || update.compare("prioritized")==0);
 	assert(algorithm.compare("vi")==0 || algorithm.compare("pi")==0 || algorithm.compare("mpi")==0);
+	assert(evaluation.compare("iterative")==0 || evaluation.compare("gmres")==0 || evaluation.compare("bicgstab")==0 || evaluation.compare("direct")==0);
 }
 
 
@@ -73,8 +99,21 @@ ModifiedPolicyIteration::ModifiedPolicyIteration(const ModifiedPolicyIteration&
 ModifiedPolicyIteration::~ModifiedPolicyIteration() {
 }
 
+void ModifiedPolicyIteration::setColoring(StateColoring * clr){
+	coloring = clr;
+}
+
+void ModifiedPolicyIteration::setGraph(StateGraph * grp){
+	graph = grp;
+}
+
+void ModifiedPolicyIteration::setPartition(WorkPartition * prt){
+	partition = prt;
+}
+
 
-void ModifiedPolicyIteration::solve(ModelType * mdl, Policy * ply, ValueVector * vv){
+template <class Model>
+void ModifiedPolicyIteration::solve(Model * mdl, Policy * ply, ValueVector * vv){
 	//The MDP is solved using the expected total discounted reward criterion.
 	//All probabilities and rewards are calculated "on demand".
 
@@ -100,6 +139,33 @@ void ModifiedPolicyIteration::solve(ModelType * mdl, Policy * ply, ValueVector *
 		vpOld = vp; //point to v to use gauss-seidel
 	}
 
+	//divide the states into chunks with equal work for the parallel standard updates
+	usePartition = parallel && useStd;
+	int nChunks = parallel ? WorkPartition::chunksPerThread * omp_get_max_threads() : 1;
+	uniformChunks.resize(nChunks + 1);
+	for (int k = 0; k <= nChunks; k++) {
+		uniformChunks[k] = (long long)model->getNumberOfStates() * k / nChunks;
+	}
+	if (usePartition) {
+		if (partition == NULL) {
+			partition = &ownPartition;
+		}
+		if (partition->empty()) {
+			partition->compute(model);
+		}
+		staleEvaluationChunks = true;
+	}
+
+	//move the part of the value vectors and the policy of each thread to its NUMA node
+	if (parallel && NumaPlacement::numberOfNodes() > 1) {
+		vector<int> stateOffsets = usePartition ? NumaPlacement::threadStates(partition->improvementChunks)
+			: NumaPlacement::threadStates(model->getNumberOfStates());
+		vector<long long> offsets(stateOffsets.begin(), stateOffsets.end());
+		NumaPlacement::place(valueVector->valueVector, offsets);
+		NumaPlacement::place(v2, offsets);
+		NumaPlacement::place(policy->policy, offsets);
+	}
+
 	//initialize tolerance depending on stopping criteria and update method
 	if (useAvg){
 		//average reward criterion
@@ -127,11 +193,44 @@ void ModifiedPolicyIteration::solve(ModelType * mdl, Policy * ply, ValueVector *
 		discount = model->getDiscount();
 	}
 	
-	//force SOR relaxation = 1 if selected GS
-	if (useGS){
+	//the linear system of the policy evaluation is singular under the average reward criterion
+	if (useAvg || useVI){
+		useLinear = false;
+		useDirect = false;
+	}
+	//the adaptive limit applies to the evaluation sweeps of MPI
+	useAdaptive = useAdaptive && useMPI && !useLinear;
+	if (useAdaptive) {
+		schedule.initialize(parIterLim, discount, model->getNumberOfStates());
+	}
+	//residual of the linear system such that the error of the values is at most epsilon/10
+	krylovTolerance = 0.1 * epsilon * (1 - discount);
+
+	//action elimination relies on the MacQueen bounds of standard updates under the discounted reward criterion
+	useElimination = useElimination && useStd && useDis && discount < 1;
+	if (useElimination) {
+		elimination.initialize(model, parallel);
+	}
+
+	//prioritized sweeping is a VI method that relies on the contraction of the discounted problem.
+	//in all other cases it falls back to GS updates.
+	if (usePrioritized && (useAvg || !useVI)){
+		usePrioritized = false;
+		useGS = true;
+	}
+
+	//force SOR relaxation = 1 if selected GS (asynchronous and prioritized updates are GS updates as well)
+	if (useGS || useAsync || usePrioritized){
 		SORrelaxation=1.0;
 	}
 
+	//the SOR relaxation is chosen from the residuals of the first sweeps
+	useAdaptiveSOR = useAdaptiveSOR && useSOR && useDis;
+	if (useAdaptiveSOR) {
+		tuner.initialize(1.9);
+		SORrelaxation = tuner.relaxation;
+	}
+
 	if (printStuff) {
 		cout << "Solving with ";
 		if (useAvg){
@@ -152,6 +251,10 @@ void ModifiedPolicyIteration::solve(ModelType * mdl, Policy * ply, ValueVector *
 			cout << "Standard";
 		} else if (useGS) {
 			cout << "Gauss-Seidel";
+		} else if (useAsync) {
+			cout << "Block-asynchronous Gauss-Seidel";
+		} else if (usePrioritized) {
+			cout << "Prioritized sweeping Gauss-Seidel";
 		} else {
 			cout << "Successive-Over Relaxation";
 		}
@@ -162,22 +265,120 @@ void ModifiedPolicyIteration::solve(ModelType * mdl, Policy * ply, ValueVector *
 			cout << "Supremum";
 		}
 		cout << " norm stopping criterion." << endl;
+		if (useDirect) {
+			cout << "Policies are evaluated with a sparse LU factorization." << endl;
+		} else if (useLinear) {
+			cout << "Policies are evaluated with " << (krylov.getMethod().compare("bicgstab") == 0 ? "BiCGSTAB." : "GMRES.") << endl;
+		}
+	}
+
+	//color the states once for parallel GS/SOR updates
+	if (parallel && !useStd && !(useVI && (useAsync || usePrioritized))) {
+		if (coloring == NULL) {
+			coloring = &ownColoring;
+		}
+		if (coloring->empty()) {
+			coloring->compute(model);
+		}
+		if (printStuff) {
+			cout << "Parallel updates over " << coloring->numberOfColors() << " colors of blocks with " << coloring->blockSize << " states." << endl;
+		}
+		//SOR may not converge in the order of the colors although it converges in the serial order.
+		//the relaxation is then reduced towards Gauss-Seidel, which converges in any order.
+		guardSOR = useSOR && !useAdaptiveSOR && SORrelaxation > 1;
+		if (guardSOR) {
+			tuner.initializeFixed(SORrelaxation);
+		}
+	}
+	if (usePartition && printStuff) {
+		cout << "Parallel updates over " << partition->numberOfChunks() << " chunks of states with equal work"
+			<< (useWorkStealing ? " (work stealing)." : ".") << endl;
+	}
+
+	//the decomposition and the Anderson acceleration rely on the contraction of the discounted problem
+	if (useAvg) {
+		useDecomposition = false;
+		andersonDepth = 0;
+	}
+
+	//predecessors of the states for prioritized sweeping, and strongly connected components for the decomposition
+	if (usePrioritized || useDecomposition) {
+		if (graph == NULL) {
+			graph = &ownGraph;
+		}
+		if (graph->empty()) {
+			graph->compute(model);
+		}
+	}
+	if (useDecomposition && graph->numberOfComponents() == 0) {
+		graph->computeComponents();
 	}
 
 	//MAIN LOOP
 	
+	//the loops over the chunks use schedule(runtime): consecutive chunks per thread, or chunks taken
+	//one at a time by the threads that are done (work stealing)
+	omp_sched_t scheduleKind;
+	int scheduleChunk;
+	omp_get_schedule(&scheduleKind, &scheduleChunk);
+	omp_set_schedule(useWorkStealing ? omp_sched_dynamic : omp_sched_static, useWorkStealing ? 1 : 0);
+
 	auto t1 = chrono::high_resolution_clock::now(); //start timer
 
 	nStates = model->getNumberOfStates();
 	iter=0;
 
+	if (useDecomposition) {
+		componentValueIteration(mdl);
+		if (useStd) {
+			v2 = valueVector->valueVector; //the standard updates start from the same values
+		}
+	}
+
+	//mixed precision: the main loop runs with single-precision probabilities until the tolerance is
+	//reached, and again with double-precision probabilities to reach the tolerance of the exact model.
+	//only the row kernels read single-precision rows, i.e., the standard updates without the LU factorization.
+	useMixed = useMixed && useStd && useDis && !useDirect;
+	if (useMixed) {
+		useMixed = model->useSinglePrecision(true);
+	}
+	if (useMixed) {
+		//row sums that differ from 1 by up to the rounding error keep the span of the differences
+		//from falling below about 2*discount*error*|differences|, so this part is not counted in the
+		//single-precision iterations.
+		roundingNoise = 4 * discount * model->singlePrecisionError();
+	}
+
+	//compressed rows of the model are read by the row kernels of the standard updates only
+	model->useKernelRows(useStd && !useDirect);
+
 	if (!useVI){
-		mainLoopModifiedPolicyIteration();
+		mainLoopModifiedPolicyIteration(mdl);
 	}else{
-		mainLoopValueIteration();
+		mainLoopValueIteration(mdl);
 	}	
 
+	if (useMixed) {
+		model->useSinglePrecision(false);
+		roundingNoise = 0;
+		norm = numeric_limits<double>::infinity(); //the policy is evaluated again in double precision
+		singleIterations = iter;
+		if (printStuff) {
+			cout << "Single-precision iterations: " << singleIterations << ". Continuing in double precision." << endl;
+		}
+		if (useElimination) {
+			elimination.initialize(model, parallel); //the bounds of the rounded model do not hold for the exact model
+		}
+		if (!useVI){
+			mainLoopModifiedPolicyIteration(mdl);
+		}else{
+			mainLoopValueIteration(mdl);
+		}
+	}
+
     auto t2 = chrono::high_resolution_clock::now(); //stop time
+	model->useKernelRows(false);
+	omp_set_schedule(scheduleKind, scheduleChunk);
 	duration = (double) chrono::duration_cast<chrono::nanoseconds>( t2 - t1 ).count() / 1e6;
 
 	//POST PROCESSING
@@ -207,6 +408,30 @@ void ModifiedPolicyIteration::solve(ModelType * mdl, Policy * ply, ValueVector *
 		}			 
 	}
 
+	finalRelaxation = SORrelaxation;
+	if (useAdaptiveSOR && printStuff) {
+		cout << "Adaptive SOR relaxation: " << SORrelaxation << "." << endl;
+	}else if (guardSOR && printStuff) {
+		cout << "SOR relaxation at the end of the parallel updates: " << SORrelaxation << "." << endl;
+	}
+
+	if (useAdaptive) {
+		parIterLims = schedule.lengths;
+		if (printStuff && !parIterLims.empty()) {
+			double mean = 0;
+			for (int lim : parIterLims) {
+				mean += lim;
+			}
+			mean /= parIterLims.size();
+			cout << "Adaptive partial evaluation limits between " << *min_element(parIterLims.begin(), parIterLims.end())
+				<< " and " << *max_element(parIterLims.begin(), parIterLims.end()) << " (mean " << mean << ")." << endl;
+		}
+	}
+
+	if (useElimination && printStuff) {
+		cout << "Action elimination: " << elimination.numberOfActiveActions() << " of " << elimination.numberOfAllActions() << " actions remain." << endl;
+	}
+
 	if(iter == iterLim && printStuff){
 		cout << "Algorithm terminated at iteration limit." << endl;
 	}else if (printStuff){
@@ -232,176 +457,244 @@ void ModifiedPolicyIteration::print(){
 		}
 }
 
-void ModifiedPolicyIteration::mainLoopModifiedPolicyIteration(){
+template <class Model>
+void ModifiedPolicyIteration::mainLoopModifiedPolicyIteration(Model * mdl){
 	//MAIN LOOP for policy iteration and modified policy iteration
 
-	if (parallel && !useSOR && !useGS && genMDP) {
-		parModifiedPolicyIterationGenMDP();
-	}else if(!useSOR && !useGS && genMDP){
-		modifiedPolicyIterationGenMDP();
-	}else if(!useSOR && !useGS && !genMDP){
-		modifiedPolicyIteration();
-	}else if((useSOR||useGS) && genMDP){
-		modifiedPolicyIterationSORGenMDP();
-	}else if((useSOR||useGS) && !genMDP){
-		modifiedPolicyIterationSOR();
+	if (parallel && useStd) {
+		parModifiedPolicyIteration(mdl);
+	}else if (parallel) {
+		parModifiedPolicyIterationSOR(mdl);
+	}else if(useStd){
+		modifiedPolicyIteration(mdl);
+	}else{
+		modifiedPolicyIterationSOR(mdl);
 	}
 
 }
 
-void ModifiedPolicyIteration::mainLoopValueIteration(){
+template <class Model>
+void ModifiedPolicyIteration::mainLoopValueIteration(Model * mdl){
 	//main loop for value iteration
 	
-	if (parallel && !useSOR && genMDP) {
-		parValueIterationGenMDP();
-	}else if(!useSOR && genMDP){
-		valueIterationGenMDP();	
-	}else if(!useSOR && !genMDP){
-		valueIteration();
-	}else if(useSOR && genMDP){
-		valueIterationSORGenMDP();
-	}else if(useSOR && !genMDP){
-		valueIterationSOR();
+	if (useStd && andersonDepth > 0) {
+		andersonValueIteration(mdl);
+	}else if (parallel && useStd) {
+		parValueIteration(mdl);
+	}else if (usePrioritized) {
+		prioritizedValueIteration(mdl); //serial
+	}else if (parallel && useAsync) {
+		asyncValueIteration(mdl);
+	}else if (parallel) {
+		parValueIterationSOR(mdl);
+	}else if(!useSOR){
+		valueIteration(mdl);
+	}else{
+		valueIterationSOR(mdl);
 	}
 }
 
-void ModifiedPolicyIteration::valueIteration(){
-	//value iteration for the built-in
-	//MDP models
+template <class Model>
+inline double ModifiedPolicyIteration::bestAction(Model * mdl, int sidx, const vector<double> &v, ActionScratch &scratch, int &aBest){
+	//maximum of r(s,a) + discount * sum_j p(j|s,a) v(j) over the actions of state sidx.
+	//the rows of all actions are collected first such that the kernel can process them together.
+	//with action elimination, only the active actions are evaluated.
+	int nActions = useElimination ? elimination.numberOfActions(sidx) : mdl->getNumberOfActions(sidx);
+	const int * actions = useElimination ? elimination.getActions(sidx) : NULL;
+	if ((int)scratch.rows.size() < nActions) {
+		scratch.bufs.resize(nActions);
+		scratch.rows.resize(nActions);
+		scratch.values.resize(nActions);
+	}
+	for (int k = 0; k < nActions; k++) {
+		int aidx = actions ? actions[k] : k;
+		scratch.rows[k] = mdl->getRow(sidx, aidx, scratch.bufs[k]);
+	}
+	kernel.dot(scratch.rows.data(), nActions, v.data(), scratch.values.data());
+
+	double valBest = -numeric_limits<double>::infinity();
+	aBest = 0;
+	for (int k = 0; k < nActions; k++) {
+		int aidx = actions ? actions[k] : k;
+		double val = mdl->reward(sidx, aidx) + discount * scratch.values[k];
+		scratch.values[k] = val;
+		if (val > valBest) {
+			valBest = val;
+			aBest = aidx;
+		}
+	}
+	if (useElimination) {
+		elimination.storeValues(sidx, scratch.values.data(), valBest);
+	}
+	return valBest;
+}
 
+inline void ModifiedPolicyIteration::reduceNorm(double diff, double &localDiffMax, double &localDiffMin, double &localSupNorm){
+	//accumulates the difference from the last iteration into the thread-local
+	//reduction variables of a parallel sweep (see setNorm)
+	if (diff > localDiffMax) {
+		localDiffMax = diff;
+	}
+	if (diff < localDiffMin) {
+		localDiffMin = diff;
+	}
+	if (fabs(diff) > localSupNorm) {
+		localSupNorm = fabs(diff);
+	}
+}
+
+template <class Model>
+inline double ModifiedPolicyIteration::updateSOR(Model * mdl, int sidx, int aidx, const vector<double> &v, RowBuffer &buf){
+	//SOR update of state sidx under action aidx (Gauss-Seidel if SORrelaxation=1)
+	double probSame;
+	TransitionRow row = mdl->getRow(sidx, aidx, buf);
+	double valSum = rowSumOffDiagonal(row, v, sidx, probSame);
+	return (1 - SORrelaxation) * v[sidx] +
+		SORrelaxation / (1 - discount * probSame) *
+		(mdl->reward(sidx, aidx) + discount * valSum); //SOR update equation
+}
+
+template <class Model>
+inline double ModifiedPolicyIteration::bestActionSOR(Model * mdl, int sidx, const vector<double> &v, RowBuffer &buf, int &aBest){
+	//maximum of the SOR update over the actions of state sidx
+	double valBest = -numeric_limits<double>::infinity();
+	aBest = 0;
+	int nActions = mdl->getNumberOfActions(sidx);
+	for (int aidx = 0; aidx < nActions; aidx++) {
+		double val = updateSOR(mdl, sidx, aidx, v, buf);
+		if (val > valBest) {
+			valBest = val;
+			aBest = aidx;
+		}
+	}
+	return valBest;
+}
+
+inline double ModifiedPolicyIteration::rowSumAtomic(const TransitionRow &row, vector<double> &v){
+	//expected value of v over a row of the transition matrix, where v may be
+	//written by other threads at the same time (asynchronous updates)
+	double valSum = 0;
+	for (int cidx=0; cidx<row.length; cidx++){
+		double vj;
+		#pragma omp atomic read
+		vj = v[row.cols[cidx]];
+		valSum += row.probs[cidx] * vj;
+	}
+	return valSum;
+}
+
+inline double ModifiedPolicyIteration::rowSumOffDiagonal(const TransitionRow &row, const vector<double> &v, int sidx, double &probSame){
+	//expected value of v over a row of the transition matrix, excluding the diagonal element.
+	//the probability of the diagonal element is stored in probSame.
+	double valSum = 0;
+	probSame = 0;
+	for (int cidx=0; cidx<row.length; cidx++){
+		if (row.cols[cidx] != sidx) { //skip diagonal element
+			valSum += row.probs[cidx] * v[row.cols[cidx]];
+		}else{
+			probSame = row.probs[cidx];
+		}
+	}
+	return valSum;
+}
+
+template <class Model>
+void ModifiedPolicyIteration::valueIteration(Model * mdl){
+	//serial value iteration with standard or
+	//Gauss-Seidel (vp==vpOld) updates
+	ActionScratch scratch;
+
+	//get the value
 	do{
 		norm = 0;
 		diffMax = -numeric_limits<double>::infinity();
 		diffMin = numeric_limits<double>::infinity();
 		for (sidx = 0; sidx < nStates; sidx++) {
-			//find the best action
-			valBest = -numeric_limits<double>::infinity();
-			model->updateNumberOfActions(sidx);
-			for (aidx = 0; aidx < model->getNumberOfActions(); aidx++) {
-				valSum = 0;
-				sf = model->postDecisionIdx(sidx, aidx);
-				model->transProb(sidx, aidx, sf);
-				do{
-					valSum += model->getPsj() * (*vpOld)[*model->getNextState()];
-					model->updateNextState(sidx, aidx, *model->getNextState());
-				}while (*model->getNextState() != sf);
-				val = model->reward(sidx, aidx) + discount * valSum;
-				if (val > valBest) {
-					valBest = val;
-				}
-			}
+			valBest = bestAction(mdl, sidx, *vpOld, scratch, aBest);
 			updateNorm(valBest);
 			(*vp)[sidx] = valBest;
 		}
-		swapPointers(); //for standard updates
-
+		if (useElimination) {
+			elimination.improvementSweep(diffMin, diffMax, discount);
+		}
+		swapPointers();
 		iter++;
 		print();
 	}while(norm >= tolerance && iter < iterLim);
-
+		
+	//get actions
 	norm = 0;
 	diffMax = -numeric_limits<double>::infinity();
 	diffMin = numeric_limits<double>::infinity();
 	for (sidx = 0; sidx < nStates; sidx++) {
-
 		//find the best action
-		valBest = -numeric_limits<double>::infinity();
-		model->updateNumberOfActions(sidx);
-		for (aidx = 0; aidx < model->getNumberOfActions(); aidx++) {
-			valSum = 0;
-			sf = model->postDecisionIdx(sidx, aidx);
-			model->transProb(sidx, aidx, sf);
-			do {
-				valSum += model->getPsj() * (*vpOld)[*model->getNextState()];
-				model->updateNextState(sidx, aidx, *model->getNextState());
-			} while (*model->getNextState() != sf);
-			val = model->reward(sidx, aidx) + discount * valSum;
-			if (val > valBest) {
-				valBest = val;
-				aBest = aidx;
-			}
-		}
+		valBest = bestAction(mdl, sidx, *vpOld, scratch, aBest);
 		policy->assignPolicy(sidx,aBest);
 		updateNorm(valBest);
 		(*vp)[sidx] = valBest;
 	}
-	swapPointers(); //for standard updates
+	swapPointers();
 }
 
+template <class Model>
+void ModifiedPolicyIteration::parValueIteration(Model * mdl){
+	//parallel value iteration with standard updates
+	const vector<int> &chunks = improvementChunks();
 
-void ModifiedPolicyIteration::valueIterationSOR(){
-
+	//get the value
 	do{
-		norm = 0;
-		diffMax = -numeric_limits<double>::infinity();
-		diffMin = numeric_limits<double>::infinity();
-		for (sidx = 0; sidx < nStates; sidx++) {
-			//find the best action
-			valBest = -numeric_limits<double>::infinity();
-			model->updateNumberOfActions(sidx);
-			for (aidx = 0; aidx < model->getNumberOfActions(); aidx++) {
-				valSum = 0;
-				probSame = 0;
-				sf = model->postDecisionIdx(sidx, aidx);
-				model->transProb(sidx, aidx, sf);
-				do{
-					if (*model->getNextState() != sidx) { //skip diagonal element
-						valSum += model->getPsj() * (*vpOld)[*model->getNextState()];
-					}else{
-						probSame=model->getPsj();
-					}
-					model->updateNextState(sidx, aidx, *model->getNextState());
-				}while(*model->getNextState() != sf);
-				val = (1 - SORrelaxation) * (*vpOld)[sidx] +
-					SORrelaxation / (1 - discount * probSame) *
-					(model->reward(sidx, aidx) + discount * valSum); //SOR update equation
-				if (val > valBest) {
-					valBest = val;
-				}	
+		double localDiffMax = -numeric_limits<double>::infinity();
+		double localDiffMin = numeric_limits<double>::infinity();
+		double localSupNorm = 0;
+		#pragma omp parallel
+		{
+			ActionScratch scratch; //thread-local row storage
+			int aBest;
+			#pragma omp for schedule(runtime) reduction(max:localDiffMax) reduction(min:localDiffMin) reduction(max:localSupNorm)
+			for (int k = 0; k < (int)chunks.size() - 1; k++) {
+				for (int sidx = chunks[k]; sidx < chunks[k + 1]; sidx++) {
+					double valBest = bestAction(mdl, sidx, *vpOld, scratch, aBest);
+					reduceNorm(valBest - (*vpOld)[sidx], localDiffMax, localDiffMin, localSupNorm);
+					(*vp)[sidx] = valBest;
+				}
 			}
-			updateNorm(valBest);
-			(*vp)[sidx] = valBest;
 		}
+		setNorm(localDiffMax, localDiffMin, localSupNorm);
+		if (useElimination) {
+			elimination.improvementSweep(diffMin, diffMax, discount);
+		}
+		swapPointers();
 		iter++;
 		print();
 	}while(norm >= tolerance && iter < iterLim);
 
-	norm = 0;
-	diffMax = -numeric_limits<double>::infinity();
-	diffMin = numeric_limits<double>::infinity();
-	for (sidx = 0; sidx < nStates; sidx++) {
-		//find the best action
-		valBest = -numeric_limits<double>::infinity();
-		model->updateNumberOfActions(sidx);
-		for (aidx = 0; aidx < model->getNumberOfActions(); aidx++) {
-			valSum = 0;
-			probSame=0;
-			sf = model->postDecisionIdx(sidx, aidx);
-			model->transProb(sidx, aidx, sf);
-			do {
-				if (*model->getNextState() != sidx) { //skip diagonal element
-					valSum += model->getPsj() * (*vpOld)[*model->getNextState()];
-				}else{
-					probSame = model->getPsj();
-				}
-				model->updateNextState(sidx, aidx, *model->getNextState());
-			} while (*model->getNextState() != sf);
-			val = (1 - SORrelaxation) * (*vpOld)[sidx] +
-				SORrelaxation / (1 - discount * probSame) *
-				(model->reward(sidx, aidx) + discount * valSum); //SOR update equation
-			if (val > valBest) {
-				valBest = val;
-				aBest = aidx;
+	double localDiffMax = -numeric_limits<double>::infinity();
+	double localDiffMin = numeric_limits<double>::infinity();
+	double localSupNorm = 0;
+	#pragma omp parallel
+	{
+		ActionScratch scratch;
+		int aBest;
+		#pragma omp for schedule(runtime) reduction(max:localDiffMax) reduction(min:localDiffMin) reduction(max:localSupNorm)
+		for (int k = 0; k < (int)chunks.size() - 1; k++) {
+			for (int sidx = chunks[k]; sidx < chunks[k + 1]; sidx++) {
+				//find the best action
+				double valBest = bestAction(mdl, sidx, *vpOld, scratch, aBest);
+				policy->assignPolicy(sidx,aBest);
+				reduceNorm(valBest - (*vpOld)[sidx], localDiffMax, localDiffMin, localSupNorm);
+				(*vp)[sidx] = valBest;
 			}
 		}
-		policy->assignPolicy(sidx,aBest);
-		updateNorm(valBest);
-		(*vp)[sidx] = valBest;
 	}
+	setNorm(localDiffMax, localDiffMin, localSupNorm);
+	swapPointers();
 }
 
-
-void ModifiedPolicyIteration::valueIterationSORGenMDP(){
+template <class Model>
+void ModifiedPolicyIteration::valueIterationSOR(Model * mdl){
+	//serial value iteration with SOR updates
+	RowBuffer buf;
+	TransitionRow row;
 
 	do{
 		norm = 0;
@@ -410,21 +703,13 @@ void ModifiedPolicyIteration::valueIterationSORGenMDP(){
 		for (sidx = 0; sidx < nStates; sidx++) {
 			//find the best action
 			valBest = -numeric_limits<double>::infinity();
-			model->updateNumberOfActions(sidx);
-			for (aidx = 0; aidx < model->getNumberOfActions(); aidx++) {
-				valSum = 0;
-				probSame = 0;
-				nJumps = model->getNumberOfJumps(sidx,aidx);
-				for (cidx=0; cidx<nJumps; cidx++){
-					if (model->getColumnIdx(sidx, aidx, cidx) != sidx) { //skip diagonal element
-						valSum += model->transProb(sidx, aidx, cidx) * (*vpOld)[model->getColumnIdx(sidx, aidx, cidx)];
-					}else{
-						probSame = model->transProb(sidx, aidx, cidx);
-					}
-				}
+			nActions = mdl->getNumberOfActions(sidx);
+			for (aidx = 0; aidx < nActions; aidx++) {
+				row = mdl->getRow(sidx, aidx, buf);
+				valSum = rowSumOffDiagonal(row, *vpOld, sidx, probSame);
 				val = (1 - SORrelaxation) * (*vpOld)[sidx] +
 					SORrelaxation / (1 - discount * probSame) *
-					(model->reward(sidx, aidx) + discount * valSum); //SOR update equation
+					(mdl->reward(sidx, aidx) + discount * valSum); //SOR update equation
 				if (val > valBest) {
 					valBest = val;
 				}
@@ -432,6 +717,9 @@ void ModifiedPolicyIteration::valueIterationSORGenMDP(){
 			updateNorm(valBest);
 			(*vp)[sidx] = valBest;
 		}
+		if (useAdaptiveSOR) {
+			SORrelaxation = tuner.sweep(norm);
+		}
 
 		iter++;
 		print();
@@ -443,21 +731,13 @@ void ModifiedPolicyIteration::valueIterationSORGenMDP(){
 	for (sidx = 0; sidx < nStates; sidx++) {
 		//find the best action
 		valBest = -numeric_limits<double>::infinity();
-		model->updateNumberOfActions(sidx);
-		for (aidx = 0; aidx < model->getNumberOfActions(); aidx++) {
-			valSum = 0;
-			probSame = 0;
-			nJumps = model->getNumberOfJumps(sidx,aidx);
-			for (cidx=0; cidx<nJumps; cidx++){
-				if (model->getColumnIdx(sidx, aidx, cidx) != sidx) { //skip diagonal element
-					valSum += model->transProb(sidx, aidx, cidx) * (*vpOld)[model->getColumnIdx(sidx, aidx, cidx)];
-				}else{
-					probSame = model->transProb(sidx, aidx, cidx);
-				}
-			}
+		nActions = mdl->getNumberOfActions(sidx);
+		for (aidx = 0; aidx < nActions; aidx++) {
+			row = mdl->getRow(sidx, aidx, buf);
+			valSum = rowSumOffDiagonal(row, *vpOld, sidx, probSame);
 			val = (1 - SORrelaxation) * (*vpOld)[sidx] +
 				SORrelaxation / (1 - discount * probSame) *
-				(model->reward(sidx, *policy->getPolicy(sidx)) + discount * valSum); //SOR update equation
+				(mdl->reward(sidx, aidx) + discount * valSum); //SOR update equation
 			if (val > valBest) {
 				valBest = val;
 				aBest = aidx;
@@ -469,184 +749,628 @@ void ModifiedPolicyIteration::valueIterationSORGenMDP(){
 	}
 }
 
-
-void ModifiedPolicyIteration::modifiedPolicyIteration(){
-	//employ modified or common policy iteration on
-	//a built-in MDP model
+template <class Model>
+void ModifiedPolicyIteration::parValueIterationSOR(Model * mdl){
+	//parallel value iteration with Gauss-Seidel or SOR updates.
+	//the blocks of a color do not depend on each other, so they are updated in
+	//parallel and in place (vp==vpOld), one color at a time (see StateColoring).
+	const vector<int> &blocks = coloring->blocks;
+	const vector<int> &colorOffsets = coloring->colorOffsets;
+	int nColors = coloring->numberOfColors();
 
 	do{
-		for (parIter=0; parIter<parIterLim; parIter++){
-			if (norm>=tolerance){ //We allow early termination before parIterLim iterations
-				norm = 0;
-				diffMax = -numeric_limits<double>::infinity();
-				diffMin = numeric_limits<double>::infinity();
-				for (sidx = 0; sidx < nStates; sidx++) {
-					valSum = 0;
-					sf = model->postDecisionIdx(sidx, *policy->getPolicy(sidx));
-					model->transProb(sidx, *policy->getPolicy(sidx), sf);
-					do {
-						valSum += model->getPsj() * (*vpOld)[*model->getNextState()];
-						model->updateNextState(sidx, *policy->getPolicy(sidx), *model->getNextState());
-					} while (*model->getNextState() != sf);
-					val = model->reward(sidx, *policy->getPolicy(sidx)) + discount * valSum;
-					updateNorm(val);
-					(*vp)[sidx] = val;
+		double localDiffMax = -numeric_limits<double>::infinity();
+		double localDiffMin = numeric_limits<double>::infinity();
+		double localSupNorm = 0;
+		#pragma omp parallel
+		{
+			ActionScratch scratch; //thread-local row storage
+			RowBuffer buf;
+			int aBest;
+			for (int color = 0; color < nColors; color++) {
+				#pragma omp for reduction(max:localDiffMax) reduction(min:localDiffMin) reduction(max:localSupNorm)
+				for (int k = colorOffsets[color]; k < colorOffsets[color+1]; k++) {
+					int blockEnd = coloring->blockEnd(blocks[k]);
+					for (int sidx = coloring->blockStart(blocks[k]); sidx < blockEnd; sidx++) {
+						double valBest;
+						if (useSOR) {
+							valBest = bestActionSOR(mdl, sidx, *vp, buf, aBest);
+						} else {
+							valBest = bestAction(mdl, sidx, *vp, scratch, aBest);
+						}
+						reduceNorm(valBest - (*vp)[sidx], localDiffMax, localDiffMin, localSupNorm);
+						(*vp)[sidx] = valBest;
+					}
 				}
-				swapPointers(); //for standard update
-			}else{
-				break; //stop partial evaluation earlier
 			}
 		}
+		setNorm(localDiffMax, localDiffMin, localSupNorm);
+		if (useAdaptiveSOR || guardSOR) {
+			SORrelaxation = tuner.sweep(norm);
+		}
+		iter++;
+		print();
+	}while(norm >= tolerance && iter < iterLim);
 
-		polChanges = 0;
-		norm = 0;
-		diffMax = -numeric_limits<double>::infinity();
-		diffMin = numeric_limits<double>::infinity();
-		for (sidx = 0; sidx < nStates; sidx++) {
+	//get actions
+	double localDiffMax = -numeric_limits<double>::infinity();
+	double localDiffMin = numeric_limits<double>::infinity();
+	double localSupNorm = 0;
+	#pragma omp parallel
+	{
+		ActionScratch scratch;
+		RowBuffer buf;
+		int aBest;
+		for (int color = 0; color < nColors; color++) {
+			#pragma omp for reduction(max:localDiffMax) reduction(min:localDiffMin) reduction(max:localSupNorm)
+			for (int k = colorOffsets[color]; k < colorOffsets[color+1]; k++) {
+				int blockEnd = coloring->blockEnd(blocks[k]);
+				for (int sidx = coloring->blockStart(blocks[k]); sidx < blockEnd; sidx++) {
+					double valBest;
+					if (useSOR) {
+						valBest = bestActionSOR(mdl, sidx, *vp, buf, aBest);
+					} else {
+						valBest = bestAction(mdl, sidx, *vp, scratch, aBest);
+					}
+					policy->assignPolicy(sidx,aBest);
+					reduceNorm(valBest - (*vp)[sidx], localDiffMax, localDiffMin, localSupNorm);
+					(*vp)[sidx] = valBest;
+				}
+			}
+		}
+	}
+	setNorm(localDiffMax, localDiffMin, localSupNorm);
+}
 
-			//find the best action
-			valBest = -numeric_limits<double>::infinity();
-			model->updateNumberOfActions(sidx);
-			for (aidx = 0; aidx < model->getNumberOfActions(); aidx++) {
-				valSum = 0;
-				sf = model->postDecisionIdx(sidx, aidx);
-				model->transProb(sidx, aidx, sf);
-				do{
-					valSum += model->getPsj() * (*vpOld)[*model->getNextState()];
-					model->updateNextState(sidx, aidx, *model->getNextState());
-				}while(*model->getNextState() != sf);
-				val = model->reward(sidx, aidx) + discount * valSum;
-				if (val > valBest) {
-					valBest = val;
-					aBest = aidx;
+template <class Model>
+void ModifiedPolicyIteration::asyncValueIteration(Model * mdl){
+	//block-asynchronous value iteration. The states are divided into one block per thread,
+	//and each thread repeats Gauss-Seidel sweeps over its block without waiting for the other
+	//threads. Values of other blocks are read with atomic loads as they are being updated.
+	//A thread reports its block as converged when a sweep changes no value by more than the
+	//tolerance, and the threads stop when all blocks are converged. A synchronous sweep then
+	//computes the residual of all states, and the asynchronous phase is repeated if needed.
+	vector<double> &v = *vp; //vp==vpOld
+	vector<double> vNew(nStates);
+	vector<int> blockConverged(omp_get_max_threads());
+
+	do{
+		int done = 0;
+		int sweeps = 0;
+		blockConverged.assign(blockConverged.size(), 0);
+		#pragma omp parallel reduction(max:sweeps)
+		{
+			int nThreads = omp_get_num_threads();
+			int thread = omp_get_thread_num();
+			int first = (long long)nStates * thread / nThreads;
+			int last = (long long)nStates * (thread + 1) / nThreads;
+			RowBuffer buf; //thread-local row storage
+			int localSweeps = 0;
+			int stop = 0;
+			while (!stop) {
+				double localNorm = 0;
+				for (int sidx = first; sidx < last; sidx++) {
+					double valBest = -numeric_limits<double>::infinity();
+					int nActions = mdl->getNumberOfActions(sidx);
+					for (int aidx = 0; aidx < nActions; aidx++) {
+						TransitionRow row = mdl->getRow(sidx, aidx, buf);
+						double val = mdl->reward(sidx, aidx) + discount * rowSumAtomic(row, v);
+						if (val > valBest) {
+							valBest = val;
+						}
+					}
+					if (fabs(valBest - v[sidx]) > localNorm) { //only this thread writes v[sidx]
+						localNorm = fabs(valBest - v[sidx]);
+					}
+					#pragma omp atomic write
+					v[sidx] = valBest;
+				}
+				//report the state of the block and check the other blocks.
+				//sweeps of a converged block are not counted as iterations, since the
+				//thread is only waiting for the other blocks.
+				int blockDone = localNorm < tolerance ? 1 : 0;
+				if (!blockDone) {
+					localSweeps++;
+				}
+				#pragma omp atomic write
+				blockConverged[thread] = blockDone;
+				int allConverged = 1;
+				for (int t = 0; t < nThreads && allConverged; t++) {
+					#pragma omp atomic read
+					allConverged = blockConverged[t];
+				}
+				if (allConverged || iter + localSweeps >= iterLim) {
+					#pragma omp atomic write
+					done = 1;
+				}
+				#pragma omp atomic read
+				stop = done;
+				if (blockDone && !stop) {
+					this_thread::yield(); //let threads of unconverged blocks run if cores are shared
 				}
 			}
-			//update policy if necessary
-			if (*policy->getPolicy(sidx) != aBest) {
-				polChanges++;
+			sweeps = localSweeps;
+		}
+		iter += sweeps;
+
+		//synchronous sweep: residual of all states and the greedy policy
+		double localDiffMax = -numeric_limits<double>::infinity();
+		double localDiffMin = numeric_limits<double>::infinity();
+		double localSupNorm = 0;
+		#pragma omp parallel
+		{
+			ActionScratch scratch;
+			int aBest;
+			#pragma omp for reduction(max:localDiffMax) reduction(min:localDiffMin) reduction(max:localSupNorm)
+			for (int sidx = 0; sidx < nStates; sidx++) {
+				double valBest = bestAction(mdl, sidx, v, scratch, aBest);
 				policy->assignPolicy(sidx,aBest);
+				reduceNorm(valBest - v[sidx], localDiffMax, localDiffMin, localSupNorm);
+				vNew[sidx] = valBest;
 			}
-			updateNorm(valBest);
-			(*vp)[sidx] = valBest;
 		}
-		swapPointers(); //for standard updates
-
+		setNorm(localDiffMax, localDiffMin, localSupNorm);
+		v.swap(vNew);
 		iter++;
 		print();
-	}while( (!usePI && norm >= tolerance && iter < iterLim) || (usePI && polChanges>0) );
+	}while(norm >= tolerance && iter < iterLim);
 }
 
+template <class Model>
+void ModifiedPolicyIteration::prioritizedValueIteration(Model * mdl){
+	//serial value iteration with prioritized sweeping (in place as GS updates). bound[s] is an upper
+	//bound on the Bellman residual |Lv - v| of state s: a backup of state s sets its residual to zero,
+	//and a change of v[s] by delta raises the residual of each predecessor p by at most
+	//discount * max_a p(s|p,a) * |delta|. States are only backed up while their bound is at least the
+	//tolerance, which is the sup norm criterion of GS, and those with the largest bounds go first.
+	//The priority queue is bucketed by powers of two of bound/tolerance: bucket b holds the states with
+	//2^b <= bound/tolerance < 2^(b+1), and each bucket is processed in FIFO order.
+	const int nBuckets = 64;
+	vector<double> &v = *vp; //vp==vpOld
+	ActionScratch scratch;
+	vector<double> bound(nStates, 0.0);
+	vector<int> bucketOf(nStates, -1); //bucket of a queued state, -1 if not queued
+	vector<vector<int> > buckets(nBuckets);
+	vector<size_t> heads(nBuckets, 0); //first unprocessed entry of each bucket
+	int topBucket = -1; //no bucket above topBucket holds any states
+	long long backups = 0;
+
+	auto enqueue = [&](int sidx){
+		//moves the state to the bucket of its bound (old entries are skipped when they are reached)
+		int b = min(nBuckets - 1, ilogb(bound[sidx] / tolerance));
+		if (b > bucketOf[sidx]) {
+			bucketOf[sidx] = b;
+			buckets[b].push_back(sidx);
+			topBucket = max(topBucket, b);
+		}
+	};
+
+	auto backup = [&](int sidx, bool queueing){
+		int aBest;
+		double val = bestAction(mdl, sidx, v, scratch, aBest);
+		double delta = fabs(val - v[sidx]);
+		v[sidx] = val;
+		bound[sidx] = 0;
+		bucketOf[sidx] = -1;
+		backups++;
+		if (delta > 0) {
+			for (long long k = graph->predOffsets[sidx]; k < graph->predOffsets[sidx + 1]; k++) {
+				int pidx = graph->pred[k];
+				bound[pidx] += discount * graph->predProbs[k] * delta;
+				if (queueing && bound[pidx] >= tolerance) {
+					enqueue(pidx);
+				}
+			}
+		}
+	};
+
+	//one GS sweep to initialize the bounds
+	for (int sidx = 0; sidx < nStates; sidx++) {
+		backup(sidx, false);
+	}
+	for (int sidx = 0; sidx < nStates; sidx++) {
+		if (bound[sidx] >= tolerance) {
+			enqueue(sidx);
+		}
+	}
+	iter = 1;
+	print();
+
+	//iter counts the backups in units of nStates
+	while (topBucket >= 0 && iter < iterLim) {
+		vector<int> &bucket = buckets[topBucket];
+		if (heads[topBucket] == bucket.size()) {
+			bucket.clear();
+			heads[topBucket] = 0;
+			topBucket--;
+			continue;
+		}
+		int sidx = bucket[heads[topBucket]++];
+		if (bucketOf[sidx] != topBucket) {
+			continue; //moved to another bucket or already backed up
+		}
+		backup(sidx, true);
+		if (backups % nStates == 0) {
+			iter++;
+			print();
+		}
+	}
+	if (printStuff) {
+		cout << "Prioritized sweeping used " << backups << " backups (" << (double)backups / nStates << " per state)." << endl;
+	}
+
+	//get actions
+	norm = 0;
+	diffMax = -numeric_limits<double>::infinity();
+	diffMin = numeric_limits<double>::infinity();
+	for (sidx = 0; sidx < nStates; sidx++) {
+		valBest = bestAction(mdl, sidx, v, scratch, aBest);
+		policy->assignPolicy(sidx,aBest);
+		updateNorm(valBest);
+		v[sidx] = valBest;
+	}
+}
 
-void ModifiedPolicyIteration::modifiedPolicyIterationSOR(){
-	//employ modified or common policy iteration on
-	//a built-in MDP model using GS or SOR updates
+template <class Model>
+void ModifiedPolicyIteration::andersonValueIteration(Model * mdl){
+	//value iteration with standard updates and Anderson acceleration (type II) of depth m = andersonDepth.
+	//With x the current iterate, g = Lx, and f = g - x, the next iterate is x = g - dG*gamma, where gamma
+	//minimizes ||f - dF*gamma||_2 and the columns of dF and dG are the differences of the last m values
+	//of f and g. Safeguard: if the residual at an extrapolated iterate is not smaller than at the previous
+	//one, the extrapolation is discarded, the history is cleared, and the plain Bellman update g of the
+	//previous iterate is used instead. x is stored in vpOld and g in vp.
+	int m = andersonDepth;
+	vector<vector<double> > dF(m, vector<double>(nStates)), dG(m, vector<double>(nStates)); //circular history
+	vector<double> gram(m * m); //gram[i*m+j] = dF[i].dF[j]
+	vector<double> fPrev(nStates), gPrev(nStates), rhs(m), gamma(m), system(m * m);
+	int nHistory = 0, newest = -1; //number of columns in the history and the most recent one
+	bool hasPrev = false; //fPrev and gPrev hold the values of an earlier iterate
+	bool extrapolated = false; //x is an extrapolated iterate
+	double normPrev = numeric_limits<double>::infinity(); //residual of the last accepted iterate
+	int rejected = 0;
+	const vector<int> &chunks = improvementChunks();
 
 	do{
-		for (parIter = 0; parIter < parIterLim; parIter++) {
-			if (norm >= tolerance) { //we allow early termination before parIterLim iterations
-				norm = 0;
-				diffMax = -numeric_limits<double>::infinity();
-				diffMin = numeric_limits<double>::infinity();
-
-				for (sidx = 0; sidx < nStates; sidx++) {
-					valSum = 0;
-					probSame = 0;
-					sf = model->postDecisionIdx(sidx, *policy->getPolicy(sidx));
-					model->transProb(sidx, *policy->getPolicy(sidx), sf);
-					do {
-						if (*model->getNextState() != sidx) { //skip diagonal element
-							valSum += model->getPsj() * (*vpOld)[*model->getNextState()];
-						}else{
-							probSame = model->getPsj();
-						}
-						model->updateNextState(sidx, *policy->getPolicy(sidx), *model->getNextState());
-					} while (*model->getNextState() != sf);
-					val = (1 - SORrelaxation) * (*vpOld)[sidx] +
-						SORrelaxation / (1 - discount * probSame) *
-						(model->reward(sidx, *policy->getPolicy(sidx)) + discount * valSum); //SOR equation in paper
-					updateNorm(val);
-					(*vp)[sidx] = val;
+		//g = Lx
+		double localDiffMax = -numeric_limits<double>::infinity();
+		double localDiffMin = numeric_limits<double>::infinity();
+		double localSupNorm = 0;
+		#pragma omp parallel if(parallel)
+		{
+			ActionScratch scratch; //thread-local row storage
+			int aBest;
+			#pragma omp for schedule(runtime) reduction(max:localDiffMax) reduction(min:localDiffMin) reduction(max:localSupNorm)
+			for (int k = 0; k < (int)chunks.size() - 1; k++) {
+				for (int sidx = chunks[k]; sidx < chunks[k + 1]; sidx++) {
+					double valBest = bestAction(mdl, sidx, *vpOld, scratch, aBest);
+					reduceNorm(valBest - (*vpOld)[sidx], localDiffMax, localDiffMin, localSupNorm);
+					(*vp)[sidx] = valBest;
 				}
-			} else {
-				break; //stop partial evaluation earlier
 			}
 		}
+		setNorm(localDiffMax, localDiffMin, localSupNorm);
+		if (useElimination) {
+			elimination.improvementSweep(diffMin, diffMax, discount);
+		}
+		iter++;
+		print();
+		if (norm < tolerance || iter >= iterLim) {
+			break;
+		}
 
-		polChanges = 0;
-		norm = 0;
-		diffMax = -numeric_limits<double>::infinity();
-		diffMin = numeric_limits<double>::infinity();
-		for (sidx = 0; sidx < nStates; sidx++) {
+		vector<double> &x = *vpOld;
+		vector<double> &g = *vp;
+		double shiftMax = -numeric_limits<double>::infinity();
+		double shiftMin = numeric_limits<double>::infinity();
+		if (extrapolated && localSupNorm >= normPrev) {
+			//safeguard: restart from the Bellman update of the last accepted iterate
+			#pragma omp parallel for reduction(max:shiftMax) reduction(min:shiftMin) if(parallel)
+			for (int sidx = 0; sidx < nStates; sidx++) {
+				shiftMax = max(shiftMax, gPrev[sidx] - g[sidx]);
+				shiftMin = min(shiftMin, gPrev[sidx] - g[sidx]);
+				x[sidx] = gPrev[sidx];
+			}
+			nHistory = 0;
+			newest = -1;
+			extrapolated = false;
+			rejected++;
+			if (useElimination) {
+				elimination.shiftBounds(shiftMin, shiftMax);
+			}
+			continue;
+		}
+		normPrev = localSupNorm;
+
+		//add the differences to the previous iterate to the history, and store f and g
+		if (hasPrev) {
+			newest = (newest + 1) % m;
+			nHistory = min(nHistory + 1, m);
+			vector<double> &dFNew = dF[newest];
+			vector<double> &dGNew = dG[newest];
+			#pragma omp parallel for if(parallel)
+			for (int sidx = 0; sidx < nStates; sidx++) {
+				double f = g[sidx] - x[sidx];
+				dFNew[sidx] = f - fPrev[sidx];
+				dGNew[sidx] = g[sidx] - gPrev[sidx];
+				fPrev[sidx] = f;
+				gPrev[sidx] = g[sidx];
+			}
+			for (int i = 0; i < nHistory; i++) {
+				vector<double> &dFi = dF[i];
+				double dot = 0;
+				#pragma omp parallel for reduction(+:dot) if(parallel)
+				for (int sidx = 0; sidx < nStates; sidx++) {
+					dot += dFi[sidx] * dFNew[sidx];
+				}
+				gram[i * m + newest] = dot;
+				gram[newest * m + i] = dot;
+			}
+		} else {
+			#pragma omp parallel for if(parallel)
+			for (int sidx = 0; sidx < nStates; sidx++) {
+				fPrev[sidx] = g[sidx] - x[sidx];
+				gPrev[sidx] = g[sidx];
+			}
+			hasPrev = true;
+		}
+		if (nHistory == 0) {
+			//plain Bellman update
+			x.swap(g);
+			extrapolated = false;
+			continue;
+		}
 
-			//find the best action
-			valBest = -numeric_limits<double>::infinity();
-			model->updateNumberOfActions(sidx);
-			for (aidx = 0; aidx < model->getNumberOfActions(); aidx++) {
-				valSum = 0;
-				probSame = 0;
-				sf = model->postDecisionIdx(sidx, aidx);
-				model->transProb(sidx, aidx, sf);
-				do {
-					if (*model->getNextState() != sidx) { //skip diagonal element
-						valSum += model->getPsj() * (*vpOld)[*model->getNextState()];
-					}else{
-						probSame = model->getPsj();
-					}
-					model->updateNextState(sidx, aidx, *model->getNextState());
-				} while (*model->getNextState() != sf);
-				val = (1 - SORrelaxation) * (*vpOld)[sidx] +
-					SORrelaxation / (1 - discount * probSame) *
-					(model->reward(sidx, aidx) + discount * valSum); //SOR update equation
-				if (val > valBest) {
-					valBest = val;
-					aBest = aidx;
+		//least squares problem through the (regularized) normal equations dF'dF gamma = dF'f
+		double maxDiagonal = 0;
+		for (int i = 0; i < nHistory; i++) {
+			vector<double> &dFi = dF[i];
+			double dot = 0;
+			#pragma omp parallel for reduction(+:dot) if(parallel)
+			for (int sidx = 0; sidx < nStates; sidx++) {
+				dot += dFi[sidx] * fPrev[sidx];
+			}
+			rhs[i] = dot;
+			maxDiagonal = max(maxDiagonal, gram[i * m + i]);
+			for (int j = 0; j < nHistory; j++) {
+				system[i * nHistory + j] = gram[i * m + j];
+			}
+		}
+		for (int i = 0; i < nHistory; i++) {
+			system[i * nHistory + i] += 1e-10 * maxDiagonal;
+		}
+		//Cholesky factorization and solve
+		bool solved = maxDiagonal > 0;
+		for (int j = 0; j < nHistory && solved; j++) {
+			double d = system[j * nHistory + j];
+			for (int k = 0; k < j; k++) {
+				d -= system[j * nHistory + k] * system[j * nHistory + k];
+			}
+			if (d <= 0) {
+				solved = false;
+				break;
+			}
+			d = sqrt(d);
+			system[j * nHistory + j] = d;
+			for (int i = j + 1; i < nHistory; i++) {
+				double e = system[i * nHistory + j];
+				for (int k = 0; k < j; k++) {
+					e -= system[i * nHistory + k] * system[j * nHistory + k];
 				}
+				system[i * nHistory + j] = e / d;
 			}
-			//update policy if necessary
-			if (*policy->getPolicy(sidx) != aBest) {
-				polChanges++;
+		}
+		if (!solved) {
+			nHistory = 0;
+			newest = -1;
+			x.swap(g);
+			extrapolated = false;
+			continue;
+		}
+		for (int i = 0; i < nHistory; i++) {
+			double e = rhs[i];
+			for (int k = 0; k < i; k++) {
+				e -= system[i * nHistory + k] * gamma[k];
+			}
+			gamma[i] = e / system[i * nHistory + i];
+		}
+		for (int i = nHistory - 1; i >= 0; i--) {
+			double e = gamma[i];
+			for (int k = i + 1; k < nHistory; k++) {
+				e -= system[k * nHistory + i] * gamma[k];
+			}
+			gamma[i] = e / system[i * nHistory + i];
+		}
+
+		//x = g - dG*gamma
+		#pragma omp parallel for reduction(max:shiftMax) reduction(min:shiftMin) if(parallel)
+		for (int sidx = 0; sidx < nStates; sidx++) {
+			double correction = 0;
+			for (int i = 0; i < nHistory; i++) {
+				correction += dG[i][sidx] * gamma[i];
+			}
+			shiftMax = max(shiftMax, -correction);
+			shiftMin = min(shiftMin, -correction);
+			x[sidx] = g[sidx] - correction;
+		}
+		if (useElimination) {
+			elimination.shiftBounds(shiftMin, shiftMax);
+		}
+		extrapolated = true;
+	}while(true);
+	swapPointers(); //vpOld points to the last Bellman update
+	if (printStuff) {
+		cout << "Anderson acceleration: " << rejected << " extrapolations rejected by the safeguard." << endl;
+	}
+
+	//get actions
+	double localDiffMax = -numeric_limits<double>::infinity();
+	double localDiffMin = numeric_limits<double>::infinity();
+	double localSupNorm = 0;
+	#pragma omp parallel if(parallel)
+	{
+		ActionScratch scratch;
+		int aBest;
+		#pragma omp for schedule(runtime) reduction(max:localDiffMax) reduction(min:localDiffMin) reduction(max:localSupNorm)
+		for (int k = 0; k < (int)chunks.size() - 1; k++) {
+			for (int sidx = chunks[k]; sidx < chunks[k + 1]; sidx++) {
+				double valBest = bestAction(mdl, sidx, *vpOld, scratch, aBest);
 				policy->assignPolicy(sidx,aBest);
+				reduceNorm(valBest - (*vpOld)[sidx], localDiffMax, localDiffMin, localSupNorm);
+				(*vp)[sidx] = valBest;
 			}
-			updateNorm(valBest);
-			(*vp)[sidx] = valBest;
 		}
+	}
+	setNorm(localDiffMax, localDiffMin, localSupNorm);
+	swapPointers();
+}
+
+template <class Model>
+void ModifiedPolicyIteration::componentValueIteration(Model * mdl){
+	//solves the strongly connected components of the transition graph one at a time in reverse
+	//topological order, such that the values of all successors outside a component are final when it
+	//is solved. Each component is solved with GS updates, where the self-transition is solved for
+	//exactly, so components with a single state are solved in one backup. The values and the policy
+	//are the starting point of the main loop, which usually confirms convergence in its first iteration.
+	vector<double> &v = valueVector->valueVector;
+	double componentTolerance = epsilon * (1 - discount) / (2 * discount); //sup norm criterion of GS
+	RowBuffer buf;
+	long long backups = 0;
+	int largest = 0;
+	for (int c = 0; c < graph->numberOfComponents(); c++) {
+		int first = graph->componentOffsets[c];
+		int last = graph->componentOffsets[c + 1];
+		largest = max(largest, last - first);
+		int sweeps = 0;
+		double componentNorm;
+		do {
+			componentNorm = 0;
+			for (int k = first; k < last; k++) {
+				int sidx = graph->componentStates[k];
+				double valBest = -numeric_limits<double>::infinity();
+				int aBest = 0;
+				int nActions = mdl->getNumberOfActions(sidx);
+				for (int aidx = 0; aidx < nActions; aidx++) {
+					double probSame;
+					TransitionRow row = mdl->getRow(sidx, aidx, buf);
+					double valSum = rowSumOffDiagonal(row, v, sidx, probSame);
+					double val = (mdl->reward(sidx, aidx) + discount * valSum) / (1 - discount * probSame);
+					if (val > valBest) {
+						valBest = val;
+						aBest = aidx;
+					}
+				}
+				componentNorm = max(componentNorm, fabs(valBest - v[sidx]));
+				v[sidx] = valBest;
+				policy->assignPolicy(sidx, aBest);
+			}
+			backups += last - first;
+			sweeps++;
+		} while (last - first > 1 && componentNorm >= componentTolerance && sweeps < iterLim);
+	}
+	if (printStuff) {
+		cout << "Solved " << graph->numberOfComponents() << " strongly connected components (largest with " << largest << " states) with " << backups << " backups (" << (double)backups / nStates << " per state)." << endl;
+	}
+}
+
+template <class Model>
+void ModifiedPolicyIteration::linearEvaluation(Model * mdl){
+	//policy evaluation by solving (I - discount*P) v = r for the current policy.
+	//the solution is stored in vpOld, which is read by the improvement step.
+	vector<double> &v = *vpOld;
+	vector<double> vOld;
+	if (useElimination) {
+		vOld = v; //to move the bounds of the action elimination along with v
+	}
+	if (useDirect) {
+		//exact solution with the LU factorization (updated for the states whose action changed)
+		if (direct.evaluate(mdl, policy->policy, discount, v)) {
+			parIter = 1;
+			if (useElimination) {
+				shiftEliminationBounds(vOld, v);
+				elimination.lower = max(elimination.lower, 0.0); //v* >= v_policy
+			}
+			return;
+		}
+		useDirect = false;
+		if (printStuff) {
+			cout << "The LU factorization requires too much memory. Policies are evaluated with GMRES." << endl;
+		}
+	}
 
+	//Krylov method where the previous values are the initial guess. The number of
+	//matrix-vector products is limited by parIterLim in MPI.
+	vector<double> rewardPolicy(nStates);
+	#pragma omp parallel for if(parallel)
+	for (int sidx = 0; sidx < nStates; sidx++) {
+		int aidx = *policy->getPolicy(sidx);
+		rewardPolicy[sidx] = mdl->reward(sidx, aidx);
+	}
 
-		iter++;
-		print();
-	}while( (!usePI && norm >= tolerance && iter < iterLim) || (usePI && polChanges>0) );
+	//y = (I - discount*P) x
+	const vector<int> &chunks = evaluationChunks();
+	auto matVec = [&](const vector<double> &x, vector<double> &y){
+		#pragma omp parallel if(parallel)
+		{
+			RowBuffer buf; //thread-local row storage
+			#pragma omp for schedule(runtime)
+			for (int k = 0; k < (int)chunks.size() - 1; k++) {
+				for (int sidx = chunks[k]; sidx < chunks[k + 1]; sidx++) {
+					int aidx = *policy->getPolicy(sidx);
+					TransitionRow row = mdl->getRow(sidx, aidx, buf);
+					y[sidx] = x[sidx] - discount * kernel.dot(row, x.data());
+				}
+			}
+		}
+	};
+
+	parIter = krylov.solve(matVec, rewardPolicy, v, krylovTolerance, usePI ? PIparIterLim : parIterLim);
+	if (useElimination) {
+		shiftEliminationBounds(vOld, v);
+	}
 }
 
-void ModifiedPolicyIteration::modifiedPolicyIterationSORGenMDP(){
-	do{
+template <class Model>
+void ModifiedPolicyIteration::modifiedPolicyIteration(Model * mdl){
+	//serial modified (and common) policy iteration with standard updates
+	RowBuffer buf;
+	TransitionRow row;
+	ActionScratch scratch;
 
-		for (parIter = 0; parIter < parIterLim; parIter++) {
-			if (norm >= tolerance) { //we allow early termination before parIterLim iterations
-				norm = 0;
-				diffMax = -numeric_limits<double>::infinity();
-				diffMin = numeric_limits<double>::infinity();
-				for (sidx = 0; sidx < nStates; sidx++) {
-					valSum = 0;
-					probSame = 0;
-					nJumps = model->getNumberOfJumps(sidx,*policy->getPolicy(sidx));
-					for (cidx=0; cidx<nJumps; cidx++){
-						if (model->getColumnIdx(sidx, *policy->getPolicy(sidx), cidx) != sidx) { //skip diagonal element
-							valSum += model->transProb(sidx, *policy->getPolicy(sidx), cidx) * (*vpOld)[model->getColumnIdx(sidx, *policy->getPolicy(sidx), cidx)];
-						}else{
-							probSame = model->transProb(sidx, *policy->getPolicy(sidx), cidx);
-						}
+	do{
+		if (useLinear) {
+			linearEvaluation(mdl); //policy evaluation by solving the linear system
+		} else {
+			if (useAdaptive) {
+				parIterLim = schedule.nextLength();
+			}
+			for (parIter = 0; parIter < parIterLim; parIter++){
+				if ( norm >= tolerance ) { //We allow early termination before parIterLim iterations
+					norm = 0;
+					diffMax = -numeric_limits<double>::infinity();
+					diffMin = numeric_limits<double>::infinity();
+					for (sidx = 0; sidx < nStates; sidx++) {
+						aidx = *policy->getPolicy(sidx);
+						row = mdl->getRow(sidx, aidx, buf);
+						val = mdl->reward(sidx, aidx) + discount * kernel.dot(row, vpOld->data());
+						updateNorm(val);
+						(*vp)[sidx] = val;
 					}
-					val = (1 - SORrelaxation) * (*vpOld)[sidx] +
-						SORrelaxation / (1 - discount * probSame) *
-						(model->reward(sidx, *policy->getPolicy(sidx)) + discount * valSum); //SOR update equation
-					updateNorm(val);
-					(*vp)[sidx] = val;
+					if (useElimination) {
+						elimination.evaluationSweep(diffMin, diffMax, discount);
+					}
+					if (useAdaptive) {
+						schedule.evaluationSweep(norm);
+					}
+					swapPointers(); //for standard update
+				} else {
+					break; //stop partial evaluation earlier
 				}
-			}else{
-				break; //stop partial evaluation earlier
 			}
 		}
 
+		if (useAdaptive) {
+			schedule.improvementStart();
+		}
 		polChanges = 0;
 		norm = 0;
 		diffMax = -numeric_limits<double>::infinity();
@@ -654,27 +1378,7 @@ void ModifiedPolicyIteration::modifiedPolicyIterationSORGenMDP(){
 		for (sidx = 0; sidx < nStates; sidx++) {
 
 			//find the best action
-			valBest = -numeric_limits<double>::infinity();
-			model->updateNumberOfActions(sidx);
-			for (aidx = 0; aidx < model->getNumberOfActions(); aidx++) {
-				valSum = 0;
-				probSame = 0;
-				nJumps = model->getNumberOfJumps(sidx,aidx);
-				for (cidx=0; cidx<nJumps; cidx++){
-					if (model->getColumnIdx(sidx, aidx, cidx) != sidx) { //skip diagonal element
-						valSum += model->transProb(sidx, aidx, cidx) * (*vpOld)[model->getColumnIdx(sidx, aidx, cidx)];
-					}else{
-						probSame = model->transProb(sidx, aidx, cidx);
-					}
-				}
-				val = (1 - SORrelaxation) * (*vpOld)[sidx] +
-					SORrelaxation / (1 - discount * probSame) *
-					(model->reward(sidx, aidx) + discount * valSum); //SOR update equation
-				if (val > valBest) {
-					valBest = val;
-					aBest = aidx;
-				}
-			}
+			valBest = bestAction(mdl, sidx, *vpOld, scratch, aBest);
 			//update policy if necessary
 			if (*policy->getPolicy(sidx) != aBest) {
 				polChanges++;
@@ -683,94 +1387,155 @@ void ModifiedPolicyIteration::modifiedPolicyIterationSORGenMDP(){
 			updateNorm(valBest);
 			(*vp)[sidx] = valBest;
 		}
-
+		if (useElimination) {
+			elimination.improvementSweep(diffMin, diffMax, discount);
+		}
+		swapPointers(); //for standard updates
+		if (useAdaptive) {
+			schedule.improvementSweep(polChanges);
+		}
 		iter++;
 		print();
-	}while( (!usePI && norm >= tolerance && iter < iterLim) || (usePI && polChanges>0) );	
+	}while( (!usePI && norm >= tolerance && iter < iterLim) || (usePI && polChanges>0) );
 }
 
-void ModifiedPolicyIteration::parModifiedPolicyIterationGenMDP(){
+template <class Model>
+void ModifiedPolicyIteration::parModifiedPolicyIteration(Model * mdl){
 	//parallelized modified (and common) policy iteration
 
 	int localPolChanges;
 	do{
-		for (parIter = 0; parIter < parIterLim; parIter++){
-			if (norm >= tolerance) { //We allow early termination before parIterLim iterations
-				#pragma omp parallel for
-				for (int sidx = 0; sidx<nStates; sidx++) {
-					double valSum = 0;
-					for (int cidx=0; cidx<model->getNumberOfJumps(sidx,*policy->getPolicy(sidx)); cidx++){
-						valSum += model->transProb(sidx, *policy->getPolicy(sidx), cidx) * (*vpOld)[model->getColumnIdx(sidx, *policy->getPolicy(sidx), cidx)];
+		if (useLinear) {
+			linearEvaluation(mdl); //policy evaluation by solving the linear system
+		} else {
+			if (useAdaptive) {
+				parIterLim = schedule.nextLength();
+			}
+			const vector<int> &chunks = evaluationChunks();
+			for (parIter = 0; parIter < parIterLim; parIter++){
+				if (norm >= tolerance) { //We allow early termination before parIterLim iterations
+					double localDiffMax = -numeric_limits<double>::infinity();
+					double localDiffMin = numeric_limits<double>::infinity();
+					double localSupNorm = 0;
+					#pragma omp parallel
+					{
+						RowBuffer buf; //thread-local row storage
+						#pragma omp for schedule(runtime) reduction(max:localDiffMax) reduction(min:localDiffMin) reduction(max:localSupNorm)
+						for (int k = 0; k < (int)chunks.size() - 1; k++) {
+							for (int sidx = chunks[k]; sidx < chunks[k + 1]; sidx++) {
+								int aidx = *policy->getPolicy(sidx);
+								TransitionRow row = mdl->getRow(sidx, aidx, buf);
+								double val = mdl->reward(sidx, aidx) + discount * kernel.dot(row, vpOld->data());
+								reduceNorm(val - (*vpOld)[sidx], localDiffMax, localDiffMin, localSupNorm);
+								(*vp)[sidx] = val;
+							}
+						}
+					}
+					setNorm(localDiffMax, localDiffMin, localSupNorm);
+					if (useElimination) {
+						elimination.evaluationSweep(diffMin, diffMax, discount);
 					}
-					double val = model->reward(sidx, *policy->getPolicy(sidx)) + discount * valSum;
-					//updateNorm(val);
-					(*vp)[sidx] = val;
+					if (useAdaptive) {
+						schedule.evaluationSweep(norm);
+					}
+					swapPointers(); //for standard update
+				} else {
+					break; //stop partial evaluation earlier
 				}
-				computeNorm();
-				swapPointers(); //for standard update
-			} else {
-				break; //stop partial evaluation earlier
 			}
 		}
 
+		if (useAdaptive) {
+			schedule.improvementStart();
+		}
+		const vector<int> &chunks = improvementChunks();
 		localPolChanges=0;
-		#pragma omp parallel for reduction(+:localPolChanges)
-		for (int sidx = 0; sidx<nStates; sidx++) {
-			//find the best action
-			double valBest = -numeric_limits<double>::infinity();
-			int aBest=0;
-			for (int aidx = 0; aidx < model->getNumberOfActions(sidx); aidx++) {
-				double valSum = 0;
-				for (int cidx=0; cidx<model->getNumberOfJumps(sidx,aidx); cidx++){
-					valSum += model->transProb(sidx, aidx, cidx) * (*vpOld)[model->getColumnIdx(sidx, aidx, cidx)];
-				}
-				double val = model->reward(sidx, aidx) + discount * valSum;
-				if (val>valBest) {
-					valBest = val;
-					aBest = aidx;
+		double localDiffMax = -numeric_limits<double>::infinity();
+		double localDiffMin = numeric_limits<double>::infinity();
+		double localSupNorm = 0;
+		#pragma omp parallel
+		{
+			ActionScratch scratch;
+			#pragma omp for schedule(runtime) reduction(+:localPolChanges) reduction(max:localDiffMax) reduction(min:localDiffMin) reduction(max:localSupNorm)
+			for (int k = 0; k < (int)chunks.size() - 1; k++) {
+				for (int sidx = chunks[k]; sidx < chunks[k + 1]; sidx++) {
+					//find the best action
+					int aBest;
+					double valBest = bestAction(mdl, sidx, *vpOld, scratch, aBest);
+					//update policy if necessary
+					if (*policy->getPolicy(sidx) != aBest) {
+						localPolChanges++;
+						policy->assignPolicy(sidx,aBest);
+					}
+					reduceNorm(valBest - (*vpOld)[sidx], localDiffMax, localDiffMin, localSupNorm);
+					(*vp)[sidx] = valBest;
 				}
 			}
-			//update policy if necessary
-			if (*policy->getPolicy(sidx) != aBest) {
-				localPolChanges++;
-				policy->assignPolicy(sidx,aBest);
-			}
-			(*vp)[sidx] = valBest;
 		}
-		computeNorm();
+		setNorm(localDiffMax, localDiffMin, localSupNorm);
+		if (useElimination) {
+			elimination.improvementSweep(diffMin, diffMax, discount);
+		}
 		swapPointers(); //for standard updates
+		polChanges=localPolChanges;
+		if (polChanges > 0) {
+			staleEvaluationChunks = true;
+		}
+		if (useAdaptive) {
+			schedule.improvementSweep(polChanges);
+		}
 		iter++;
 		print();
 	}while( (!usePI && norm >= tolerance && iter < iterLim) || (usePI && localPolChanges>0) );
-	polChanges=localPolChanges;
 }
 
-
-
-void ModifiedPolicyIteration::modifiedPolicyIterationGenMDP(){
+template <class Model>
+void ModifiedPolicyIteration::modifiedPolicyIterationSOR(Model * mdl){
 	//serial modified (and common) policy iteration
+	//with Gauss-Seidel or SOR updates
+	RowBuffer buf;
+	TransitionRow row;
+
 	do{
-		for (parIter = 0; parIter < parIterLim; parIter++){
-			if ( norm >= tolerance ) { //We allow early termination before parIterLim iterations
-				norm = 0;
-				diffMax = -numeric_limits<double>::infinity();
-				diffMin = numeric_limits<double>::infinity();
-				for (sidx = 0; sidx < nStates; sidx++) {
-					valSum = 0;
-					nJumps = model->getNumberOfJumps(sidx,*policy->getPolicy(sidx));
-					for (cidx=0; cidx<nJumps; cidx++){
-						valSum += model->transProb(sidx, *policy->getPolicy(sidx), cidx) * (*vpOld)[model->getColumnIdx(sidx, *policy->getPolicy(sidx), cidx)];
+		if (useLinear) {
+			linearEvaluation(mdl); //policy evaluation by solving the linear system
+		} else {
+			if (useAdaptive) {
+				parIterLim = schedule.nextLength();
+			}
+			if (useAdaptiveSOR) {
+				tuner.restart(); //the improvement sweep changed the policy
+			}
+			for (parIter = 0; parIter < parIterLim; parIter++) {
+				if (norm >= tolerance) { //we allow early termination before parIterLim iterations
+					norm = 0;
+					diffMax = -numeric_limits<double>::infinity();
+					diffMin = numeric_limits<double>::infinity();
+					for (sidx = 0; sidx < nStates; sidx++) {
+						aidx = *policy->getPolicy(sidx);
+						row = mdl->getRow(sidx, aidx, buf);
+						valSum = rowSumOffDiagonal(row, *vpOld, sidx, probSame);
+						val = (1 - SORrelaxation) * (*vpOld)[sidx] +
+							SORrelaxation / (1 - discount * probSame) *
+							(mdl->reward(sidx, aidx) + discount * valSum); //SOR update equation
+						updateNorm(val);
+						(*vp)[sidx] = val;
+					}
+					if (useAdaptive) {
+						schedule.evaluationSweep(norm);
 					}
-					val = model->reward(sidx, *policy->getPolicy(sidx)) + discount * valSum;
-					updateNorm(val);
-					(*vp)[sidx] = val;
+					if (useAdaptiveSOR) {
+						SORrelaxation = tuner.sweep(norm);
+					}
+				}else{
+					break; //stop partial evaluation earlier
 				}
-				swapPointers(); //for standard update
-			} else {
-				break; //stop partial evaluation earlier
 			}
 		}
 
+		if (useAdaptive) {
+			schedule.improvementStart();
+		}
 		polChanges = 0;
 		norm = 0;
 		diffMax = -numeric_limits<double>::infinity();
@@ -779,14 +1544,13 @@ void ModifiedPolicyIteration::modifiedPolicyIterationGenMDP(){
 
 			//find the best action
 			valBest = -numeric_limits<double>::infinity();
-			model->updateNumberOfActions(sidx);
-			for (aidx = 0; aidx < model->getNumberOfActions(); aidx++) {
-				valSum = 0;
-				nJumps = model->getNumberOfJumps(sidx,aidx);
-				for (cidx=0; cidx<nJumps; cidx++){
-					valSum += model->transProb(sidx, aidx, cidx) * (*vpOld)[model->getColumnIdx(sidx, aidx, cidx)];
-				}
-				val = model->reward(sidx, aidx) + discount * valSum;
+			nActions = mdl->getNumberOfActions(sidx);
+			for (aidx = 0; aidx < nActions; aidx++) {
+				row = mdl->getRow(sidx, aidx, buf);
+				valSum = rowSumOffDiagonal(row, *vpOld, sidx, probSame);
+				val = (1 - SORrelaxation) * (*vpOld)[sidx] +
+					SORrelaxation / (1 - discount * probSame) *
+					(mdl->reward(sidx, aidx) + discount * valSum); //SOR update equation
 				if (val > valBest) {
 					valBest = val;
 					aBest = aidx;
@@ -800,114 +1564,119 @@ void ModifiedPolicyIteration::modifiedPolicyIterationGenMDP(){
 			updateNorm(valBest);
 			(*vp)[sidx] = valBest;
 		}
-		swapPointers(); //for standard updates
+		if (useAdaptive) {
+			schedule.improvementSweep(polChanges);
+		}
+
 		iter++;
 		print();
-	}while( (!usePI && norm >= tolerance && iter < iterLim) || (usePI && polChanges>0) );
+	}while( (!usePI && norm >= tolerance && iter < iterLim) || (usePI && polChanges>0) );	
 }
 
-void ModifiedPolicyIteration::parValueIterationGenMDP(){
+template <class Model>
+void ModifiedPolicyIteration::parModifiedPolicyIterationSOR(Model * mdl){
+	//parallel modified (and common) policy iteration with Gauss-Seidel or SOR
+	//updates. The blocks of each color are updated in parallel and in place (vp==vpOld).
+	const vector<int> &blocks = coloring->blocks;
+	const vector<int> &colorOffsets = coloring->colorOffsets;
+	int nColors = coloring->numberOfColors();
 
-	//get the value
+	int localPolChanges;
 	do{
-    	#pragma omp parallel for
-    	for (int sidx = 0; sidx < nStates; sidx++) {
-        	double valBest = -numeric_limits<double>::infinity();
-        	for (int aidx = 0; aidx < model->getNumberOfActions(sidx); aidx++) {
-            	double valSum = 0;
-            	for (int cidx = 0; cidx < model->getNumberOfJumps(sidx,aidx); cidx++) {
-                	valSum += model->transProb(sidx, aidx, cidx) * (*vpOld)[model->getColumnIdx(sidx, aidx, cidx)];
-            	}
-            	double val = model->reward(sidx, aidx) + discount * valSum;
-            	if (val > valBest) {
-                	valBest = val;
-            	}
-        	}
-        	(*vp)[sidx] = valBest;
-    	}
-		computeNorm();
-		swapPointers();
-		iter++;
-		print();
-	}while(norm >= tolerance && iter < iterLim);
-
-	#pragma omp parallel for
-	for (int sidx = 0; sidx < nStates; sidx++) {
-		//find the best action
-		double valBest = -numeric_limits<double>::infinity();
-		int aBest=0;
-		for (int aidx = 0; aidx < model->getNumberOfActions(sidx); aidx++) {
-			double valSum = 0;
-			for (int cidx=0; cidx<model->getNumberOfJumps(sidx,aidx); cidx++){
-				valSum += model->transProb(sidx, aidx, cidx) * (*vpOld)[model->getColumnIdx(sidx, aidx, cidx)];
+		if (useLinear) {
+			linearEvaluation(mdl); //policy evaluation by solving the linear system
+		} else {
+			if (useAdaptive) {
+				parIterLim = schedule.nextLength();
 			}
-			double val = model->reward(sidx, aidx) + discount * valSum;
-			if (val > valBest) {
-				valBest = val;
-				aBest = aidx;
+			if (useAdaptiveSOR || guardSOR) {
+				tuner.restart(); //the improvement sweep changed the policy
+			}
+			for (parIter = 0; parIter < parIterLim; parIter++) {
+				if (norm >= tolerance) { //we allow early termination before parIterLim iterations
+					double localDiffMax = -numeric_limits<double>::infinity();
+					double localDiffMin = numeric_limits<double>::infinity();
+					double localSupNorm = 0;
+					#pragma omp parallel
+					{
+						RowBuffer buf; //thread-local row storage
+						for (int color = 0; color < nColors; color++) {
+							#pragma omp for reduction(max:localDiffMax) reduction(min:localDiffMin) reduction(max:localSupNorm)
+							for (int k = colorOffsets[color]; k < colorOffsets[color+1]; k++) {
+								int blockEnd = coloring->blockEnd(blocks[k]);
+								for (int sidx = coloring->blockStart(blocks[k]); sidx < blockEnd; sidx++) {
+									double val = updateSOR(mdl, sidx, *policy->getPolicy(sidx), *vp, buf);
+									reduceNorm(val - (*vp)[sidx], localDiffMax, localDiffMin, localSupNorm);
+									(*vp)[sidx] = val;
+								}
+							}
+						}
+					}
+					setNorm(localDiffMax, localDiffMin, localSupNorm);
+					if (useAdaptive) {
+						schedule.evaluationSweep(norm);
+					}
+					if (useAdaptiveSOR || guardSOR) {
+						SORrelaxation = tuner.sweep(norm);
+					}
+				}else{
+					break; //stop partial evaluation earlier
+				}
 			}
 		}
-		policy->assignPolicy(sidx,aBest);
-		(*vp)[sidx] = valBest;
-	}
-	computeNorm();
-	swapPointers();
-}
-
-void ModifiedPolicyIteration::valueIterationGenMDP(){
 
-	//get the value
-	do{
-		norm = 0;
-		diffMax = -numeric_limits<double>::infinity();
-		diffMin = numeric_limits<double>::infinity();
-		for (sidx = 0; sidx < nStates; sidx++) {
-			valBest = -numeric_limits<double>::infinity();
-			model->updateNumberOfActions(sidx);
-			for (aidx = 0; aidx < model->getNumberOfActions(); aidx++) {
-				valSum = 0;
-				nJumps = model->getNumberOfJumps(sidx,aidx);
-				for (cidx=0; cidx<nJumps; cidx++){
-					valSum += model->transProb(sidx, aidx, cidx) * (*vpOld)[model->getColumnIdx(sidx, aidx, cidx)];
-				}
-				val = model->reward(sidx, aidx) + discount * valSum;
-				if (val > valBest) {
-					valBest = val;
+		if (useAdaptive) {
+			schedule.improvementStart();
+		}
+		localPolChanges = 0;
+		double localDiffMax = -numeric_limits<double>::infinity();
+		double localDiffMin = numeric_limits<double>::infinity();
+		double localSupNorm = 0;
+		#pragma omp parallel
+		{
+			RowBuffer buf;
+			for (int color = 0; color < nColors; color++) {
+				#pragma omp for reduction(+:localPolChanges) reduction(max:localDiffMax) reduction(min:localDiffMin) reduction(max:localSupNorm)
+				for (int k = colorOffsets[color]; k < colorOffsets[color+1]; k++) {
+					int blockEnd = coloring->blockEnd(blocks[k]);
+					for (int sidx = coloring->blockStart(blocks[k]); sidx < blockEnd; sidx++) {
+						//find the best action
+						int aBest;
+						double valBest = bestActionSOR(mdl, sidx, *vp, buf, aBest);
+						//update policy if necessary
+						if (*policy->getPolicy(sidx) != aBest) {
+							localPolChanges++;
+							policy->assignPolicy(sidx,aBest);
+						}
+						reduceNorm(valBest - (*vp)[sidx], localDiffMax, localDiffMin, localSupNorm);
+						(*vp)[sidx] = valBest;
+					}
 				}
 			}
-			updateNorm(valBest);
-			(*vp)[sidx] = valBest;
 		}
-		swapPointers();
+		setNorm(localDiffMax, localDiffMin, localSupNorm);
+		polChanges=localPolChanges;
+		if (useAdaptive) {
+			schedule.improvementSweep(polChanges);
+		}
 		iter++;
 		print();
-	}while(norm >= tolerance && iter < iterLim);
-		
-	//get actions
-	norm = 0;
-	diffMax = -numeric_limits<double>::infinity();
-	diffMin = numeric_limits<double>::infinity();
-	for (sidx = 0; sidx < nStates; sidx++) {
-		//find the best action
-		valBest = -numeric_limits<double>::infinity();
-		model->updateNumberOfActions(sidx);
-		for (aidx = 0; aidx < model->getNumberOfActions(); aidx++) {
-			valSum = 0;
-			nJumps = model->getNumberOfJumps(sidx,aidx);
-			for (cidx=0; cidx<nJumps; cidx++){
-				valSum += model->transProb(sidx, aidx, cidx) * (*vpOld)[model->getColumnIdx(sidx, aidx, cidx)];
-			}
-			val = model->reward(sidx, aidx) + discount * valSum;
-			if (val > valBest) {
-				valBest = val;
-				aBest = aidx;
-			}
-		}
-		policy->assignPolicy(sidx,aBest);
-		updateNorm(valBest);
-		(*vp)[sidx] = valBest;
+	}while( (!usePI && norm >= tolerance && iter < iterLim) || (usePI && localPolChanges>0) );
+}
+
+const vector<int> &ModifiedPolicyIteration::improvementChunks(){
+	return usePartition ? partition->improvementChunks : uniformChunks;
+}
+
+const vector<int> &ModifiedPolicyIteration::evaluationChunks(){
+	if (!usePartition) {
+		return uniformChunks;
 	}
-	swapPointers();
+	if (staleEvaluationChunks) {
+		partition->computeEvaluation(policy->policy);
+		staleEvaluationChunks = false;
+	}
+	return partition->evaluationChunks;
 }
 
 void ModifiedPolicyIteration::initValue(){
@@ -921,8 +1690,8 @@ void ModifiedPolicyIteration::initValue(){
 	for (sidx = 0; sidx < model->getNumberOfStates(); ++sidx) {
 
 		maxRew = -numeric_limits<double>::infinity();
-		model->updateNumberOfActions(sidx);
-		for (aidx = 0; aidx < model->getNumberOfActions(); aidx++) {
+		nActions = model->getNumberOfActions(sidx);
+		for (aidx = 0; aidx < nActions; aidx++) {
 			if (model->reward(sidx, aidx) > maxRew) {
 				if (initPol){
 					policy->assignPolicy(sidx,aidx); //argmax_a r(s,a)
@@ -966,8 +1735,8 @@ void ModifiedPolicyIteration::checkFinalValue() {
 	int s,a;
 
 	for (s = 0; s < model->getNumberOfStates(); s++) {
-		model->updateNumberOfActions(s);
-		for (a = 0; a < model->getNumberOfActions(); a++) {
+		int nA = model->getNumberOfActions(s);
+		for (a = 0; a < nA; a++) {
 			r = model->reward(s, a);
 			if (r < minRew) {
 				minRew = r;
@@ -1009,7 +1778,7 @@ void ModifiedPolicyIteration::updateNorm(double &val) {
 		diffMin = diff;
 	}
 	if (useStd) { //span norm
-		norm = diffMax - diffMin;
+		norm = diffMax - diffMin - roundingNoise * max(fabs(diffMax), fabs(diffMin));
 	} else { //supremum norm
 		if (fabs(diff) > norm) {
 			norm = fabs(diff);
@@ -1017,26 +1786,34 @@ void ModifiedPolicyIteration::updateNorm(double &val) {
 	}
 }
 
-void ModifiedPolicyIteration::computeNorm() {
-	double localDiffMax = -numeric_limits<double>::infinity();
-	double localDiffMin = numeric_limits<double>::infinity();
-	#pragma omp parallel for reduction(max:localDiffMax) reduction(min:localDiffMin)
-	for (int sidx=0; sidx<nStates; sidx++){
-		double diff = (*vp)[sidx] - (*vpOld)[sidx];
-		if (diff>localDiffMax) {
-			localDiffMax = diff;
-		}
-		if (diff<localDiffMin) {
-			localDiffMin = diff;
-		}
-	}
-	diffMax=localDiffMax;
-	diffMin=localDiffMin;
+void ModifiedPolicyIteration::setNorm(double localDiffMax, double localDiffMin, double localSupNorm) {
+	//sets diffMax, diffMin, and span/supNorm from the reductions of a parallel sweep
+	diffMax = localDiffMax;
+	diffMin = localDiffMin;
 	if (useStd) { //span norm
-		norm = diffMax - diffMin;
+		norm = diffMax - diffMin - roundingNoise * max(fabs(diffMax), fabs(diffMin));
 	} else { //supremum norm
-		if (fabs(diff) > norm) {
-			norm = fabs(diff);
-		}
+		norm = localSupNorm;
+	}
+}
+
+void ModifiedPolicyIteration::shiftEliminationBounds(const vector<double> &vOld, const vector<double> &v) {
+	//moves the bounds of the action elimination from vOld to v
+	double localDiffMax = -numeric_limits<double>::infinity();
+	double localDiffMin = numeric_limits<double>::infinity();
+	#pragma omp parallel for reduction(max:localDiffMax) reduction(min:localDiffMin) if(parallel)
+	for (int sidx = 0; sidx < nStates; sidx++) {
+		double diff = v[sidx] - vOld[sidx];
+		localDiffMax = max(localDiffMax, diff);
+		localDiffMin = min(localDiffMin, diff);
 	}
-}	
\ No newline at end of file
+	elimination.shiftBounds(localDiffMin, localDiffMax);
+}
+
+
+//explicit instantiations of the solver for each model type.
+//a new built-in model (see templates/MyModel) is added with a similar line.
+template void ModifiedPolicyIteration::solve<GeneralMDPmodel>(GeneralMDPmodel * mdl, Policy * ply, ValueVector * vv);
+template void ModifiedPolicyIteration::solve<TBMmodel>(TBMmodel * mdl, Policy * ply, ValueVector * vv);
+template void ModifiedPolicyIteration::solve<CBMmodel>(CBMmodel * mdl, Policy * ply, ValueVector * vv);
+template void ModifiedPolicyIteration::solve<ModelType>(ModelType * mdl, Policy * ply, ValueVector * vv); //any model through virtual calls
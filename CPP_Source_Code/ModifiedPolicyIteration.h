@@ -23,6 +23,15 @@
 */
 
 #include "ModelType.h"
+#include "RowKernel.h"
+#include "StateColoring.h"
+#include "StateGraph.h"
+#include "WorkPartition.h"
+#include "KrylovSolver.h"
+#include "DirectEvaluation.h"
+#include "ActionElimination.h"
+#include "EvaluationSchedule.h"
+#include "RelaxationTuner.h"
 #include "Policy.h"
 #include "ValueVector.h"
 #include "TBMmodel.h" //Time-based maintenance model
@@ -35,13 +44,21 @@ using namespace std;
 #ifndef MODIFIEDPOLICYITERATION_H
 #define MODIFIEDPOLICYITERATION_H
 
+//thread-local storage for evaluating all actions of a state together.
+//one row buffer per action, since models such as the TBM and CBM models generate their rows on demand.
+struct ActionScratch {
+    vector<RowBuffer> bufs;
+    vector<TransitionRow> rows;
+    vector<double> values;
+};
+
 class ModifiedPolicyIteration {
 public:
     
     ModifiedPolicyIteration() {};
     ModifiedPolicyIteration(double eps=1e-3, string algorithm = "mpi", string update = "standard", string criterion = "discounted",
             int parIterLim = 100, double SORrelaxation = 1.0, bool verbose=true, bool postProcessing=true,
-             bool makeFinalCheck=true, bool parallel=true, bool genMDP=true);
+             bool makeFinalCheck=true, bool parallel=true, bool genMDP=true, string evaluation = "iterative", bool decompose = false, int andersonDepth = 0, bool adaptiveParIter = false, bool adaptiveSOR = false, bool workStealing = false, bool mixedPrecision = false, bool actionElimination = true);
     
     ModifiedPolicyIteration(const ModifiedPolicyIteration& orig);
     virtual ~ModifiedPolicyIteration();
@@ -51,21 +68,49 @@ public:
     int iter;
     bool converged;
     int polChanges; //count changes in policy in each iteration
+    vector<int> parIterLims; //partial evaluation limit of each iteration (adaptive MPI only)
+    double finalRelaxation; //SOR relaxation at the end of the solve
+    int singleIterations; //iterations with single-precision probabilities (mixed precision only)
 
     //methods
-    void solve(ModelType * mdl, Policy * ply, ValueVector * vv);
+    //the solver is templated on the model type so that the calls in the inner loops are resolved
+    //at compile time. The supported model types are instantiated at the end of ModifiedPolicyIteration.cpp.
+    template <class Model> void solve(Model * mdl, Policy * ply, ValueVector * vv);
+    void setColoring(StateColoring * clr); //coloring reused between solves (parallel GS/SOR only)
+    void setGraph(StateGraph * grp); //graph reused between solves (prioritized sweeping and decomposition only)
+    void setPartition(WorkPartition * prt); //partition reused between solves (parallel standard updates only)
     
 private:
 
     //parameters
-    double epsilon, diffMax, diffMin, diff, norm, tolerance, SORrelaxation, val, valBest, valSum, probSame, discount;
-    int iterLim, parIter, parIterLim, PIparIterLim, sf, sidx, aidx, cidx, aBest, nJumps, nStates, nActions;
-    bool useMPI, usePI, useVI, useStd, useGS, useSOR, useDis, useAvg, initPol, initVal, printStuff, postProcessing, makeFinalCheck, genMDP, parallel;
+    double roundingNoise; //part of the span norm caused by single-precision probabilities (relative to the differences)
+    double epsilon, diffMax, diffMin, diff, norm, tolerance, krylovTolerance, SORrelaxation, val, valBest, valSum, probSame, discount;
+    int iterLim, andersonDepth, parIter, parIterLim, PIparIterLim, sf, sidx, aidx, cidx, aBest, nJumps, nStates, nActions;
+    bool useMPI, usePI, useVI, useStd, useGS, useSOR, useAsync, usePrioritized, useLinear, useDirect, useElimination, useDecomposition, useAdaptive, useAdaptiveSOR, guardSOR, usePartition, useWorkStealing, useMixed, staleEvaluationChunks, useDis, useAvg, initPol, initVal, printStuff, postProcessing, makeFinalCheck, genMDP, parallel;
 
     //pointer to model, policy, and value vector
     ModelType * model;
     Policy * policy;
     ValueVector * valueVector;
+
+    //coloring of the states for parallel GS/SOR updates
+    StateColoring * coloring; //points to ownColoring unless set by setColoring
+    StateColoring ownColoring;
+
+    //transition graph of the states for prioritized sweeping and the decomposition
+    StateGraph * graph; //points to ownGraph unless set by setGraph
+    StateGraph ownGraph;
+
+    //chunks of states with equal work for the parallel standard updates
+    WorkPartition * partition; //points to ownPartition unless set by setPartition
+    WorkPartition ownPartition;
+    vector<int> uniformChunks; //chunks with equal numbers of states (without the partition)
+
+    KrylovSolver krylov; //policy evaluation with GMRES/BiCGSTAB
+    DirectEvaluation direct; //policy evaluation with a sparse LU factorization
+    ActionElimination elimination; //active actions of each state (standard updates only)
+    EvaluationSchedule schedule; //partial evaluation limit of each iteration (adaptive MPI only)
+    RelaxationTuner tuner; //SOR relaxation chosen from the residuals (adaptive SOR and parallel SOR only)
     
     //Pointers so we don't have to copy full vectors (for standard value function updates)
     vector<double> v2; //second value vector required when using standard updates
@@ -74,20 +119,35 @@ private:
     vector<double> *vpTemp; //temporary pointer used when swapping vp and vpOld
 
     //methods
-    void mainLoopModifiedPolicyIteration();
-    void mainLoopValueIteration();
+    template <class Model> void mainLoopModifiedPolicyIteration(Model * mdl);
+    template <class Model> void mainLoopValueIteration(Model * mdl);
+    
+    template <class Model> void modifiedPolicyIteration(Model * mdl); //MPI/PI with standard or GS updates (serial computation)
+    template <class Model> void parModifiedPolicyIteration(Model * mdl); //MPI/PI with standard updates (parallel computation)
+    template <class Model> void modifiedPolicyIterationSOR(Model * mdl); //MPI/PI with GS/SOR updates (serial computation)
+    template <class Model> void parModifiedPolicyIterationSOR(Model * mdl); //MPI/PI with GS/SOR updates (parallel computation over colors)
+
+    template <class Model> void valueIteration(Model * mdl); //VI with standard or GS updates (serial computation)
+    template <class Model> void parValueIteration(Model * mdl); //VI with standard updates (parallel computation)
+    template <class Model> void valueIterationSOR(Model * mdl); //VI with SOR updates (serial computation)
+    template <class Model> void parValueIterationSOR(Model * mdl); //VI with GS/SOR updates (parallel computation over colors)
+    template <class Model> void asyncValueIteration(Model * mdl); //VI with block-asynchronous GS updates (parallel computation)
+    template <class Model> void prioritizedValueIteration(Model * mdl); //VI with GS updates in order of the Bellman residuals (serial computation)
+    template <class Model> void andersonValueIteration(Model * mdl); //VI with standard updates and Anderson acceleration (serial or parallel computation)
+    template <class Model> void componentValueIteration(Model * mdl); //solves the strongly connected components in reverse topological order before the main loop
+
+    template <class Model> void linearEvaluation(Model * mdl); //evaluates the policy with a Krylov method or an LU factorization (replaces the partial evaluation sweeps)
+
+    //row kernels shared by all loops
+    RowKernel kernel; //SIMD row products selected at runtime
+    template <class Model> double bestAction(Model * mdl, int sidx, const vector<double> &v, ActionScratch &scratch, int &aBest);
+    template <class Model> double updateSOR(Model * mdl, int sidx, int aidx, const vector<double> &v, RowBuffer &buf);
+    template <class Model> double bestActionSOR(Model * mdl, int sidx, const vector<double> &v, RowBuffer &buf, int &aBest);
+    static double rowSumOffDiagonal(const TransitionRow &row, const vector<double> &v, int sidx, double &probSame);
+    static double rowSumAtomic(const TransitionRow &row, vector<double> &v); //rowSum with atomic reads of v
     
-    void modifiedPolicyIterationGenMDP(); //MPI/PI for general MDP models (serial computation)
-    void parModifiedPolicyIterationGenMDP(); //MPI/PI for general MDP models (parallel computation)
-    void modifiedPolicyIterationSORGenMDP(); //MPI/PI with GS/SOR updates for general MDP models (serial computation)   
-    void modifiedPolicyIteration(); //MPI/PI for built-in MDP models (serial computation)
-    void modifiedPolicyIterationSOR(); //MPI/PI with GS/SOR updates for built-in MDP models (serial computation)   
-
-    void valueIterationGenMDP(); //VI for general MDP models (serial computation)
-    void parValueIterationGenMDP(); //VI for general MDP models (parallel computation)
-    void valueIterationSORGenMDP(); //VI with GS/SOR updates for general MDP models (serial computation)
-    void valueIteration(); //VI for built-in MDP models (serial computation)    
-    void valueIterationSOR(); //VI with GS/SOR updates for built-in MDP models (serial computation)
+    const vector<int> &improvementChunks(); //chunks of the improvement sweeps
+    const vector<int> &evaluationChunks(); //chunks of the evaluation sweeps (recomputed when the policy has changed)
     
     void initValue(); //initializes policy, v, and span
     void checkFinalValue();
@@ -96,7 +156,9 @@ private:
     //other methods
     void swapPointers(); //swaps vp and vpOld.
     void updateNorm(double &valBest); //updates diffMax, diffMin, and span/supNorm
-    void computeNorm();
+    static void reduceNorm(double diff, double &localDiffMax, double &localDiffMin, double &localSupNorm); //thread-local part of updateNorm
+    void setNorm(double localDiffMax, double localDiffMin, double localSupNorm); //updates diffMax, diffMin, and span/supNorm after a parallel sweep
+    void shiftEliminationBounds(const vector<double> &vOld, const vector<double> &v); //moves the action elimination bounds after a linear solve
     
 };
 
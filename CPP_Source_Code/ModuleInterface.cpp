@@ -23,7 +23,8 @@
 */
 
 #include <fstream>
-#include <sstream>
+#include <algorithm>
+#include <omp.h>
 
 #include "ModuleInterface.h"
 
@@ -36,40 +37,88 @@ ModuleInterface::ModuleInterface(const ModuleInterface& orig) {
 ModuleInterface::~ModuleInterface() {
 }
 
+//NumPy arrays of the inputs. Arrays of other types or layouts are converted by NumPy.
+typedef py::array_t<double, py::array::c_style | py::array::forcecast> DoubleArray;
+typedef py::array_t<int, py::array::c_style | py::array::forcecast> IntArray;
+typedef py::array_t<long long, py::array::c_style | py::array::forcecast> OffsetArray;
+
+static bool isGiven(py::object argument){
+    //arguments that are not given are None or empty lists
+    if (argument.is_none()){
+        return false;
+    }
+    return !py::isinstance<py::list>(argument) || py::len(argument)!=0;
+}
+
+static bool validColumns(const int * cols, long long n, int numberOfStates){
+    bool valid=true;
+    #pragma omp parallel for reduction(&&:valid)
+    for (long long i=0; i<n; i++){
+        valid = valid && cols[i]>=0 && cols[i]<numberOfStates;
+    }
+    if (!valid){
+        cerr << "Error: The transition probabilities contain a column index that is negative or not smaller than the number of states." << endl;
+    }
+    return valid;
+}
+
 void ModuleInterface::mdp(double discount,
-    py::list rewards, 
-    py::list rewardsElementwise,
+    py::object rewards, 
+    py::object rewardsElementwise,
     string rewardsFromFile,
-    py::list tranMatWithZeros,
-    py::list tranMatElementwise,
+    py::object tranMatWithZeros,
+    py::object tranMatElementwise,
     py::list tranMatProbs,
     py::list tranMatColumns, 
-    string tranMatFromFile){
+    string tranMatFromFile,
+    string modelFromFile,
+    py::object tranMatSparse){
+    unique_lock<mutex> lock=lockModel();
     //select the general MDP problem
     problem.problemType="mdp";
+    problem.coloring.clear();
+    problem.graph.clear();
+    problem.partition.clear();
+    problem.placedThreads=0;
     problem.discount=discount;
     settings.genMDP=true;
+    problem.modelFile.close();
+    problem.tranMat.setNumberOfRows(0); //releases the arrays of the previous model before they are freed
+    problem.rewards.setNumberOfRows(0);
+    problem.externalArrays=py::list();
+
+    //map the rewards and the transition probabilities from a binary model file
+    if (!modelFromFile.empty()){
+        py::gil_scoped_release release;
+        problem.modelFile.open(modelFromFile,problem.tranMat,problem.rewards);
+        return;
+    }
 
     //load the rewards
-    if (rewards.size()!=0){
-        problem.rewards.assignRewardsFromList(rewards);
-    }else if(rewardsElementwise.size()!=0){
+    if (isGiven(rewards)){
+        loadRewards(rewards);
+    }else if(isGiven(rewardsElementwise)){
         loadRewardsElementwise(rewardsElementwise);
     }else{
+        py::gil_scoped_release release;
         loadRewardsFromFile(rewardsFromFile,',',true);
     }
 
     //load the transition probabilities
-    if (tranMatWithZeros.size()!=0){
+    if (isGiven(tranMatSparse)){
+        loadTranMatSparse(tranMatSparse);
+    }else if (isGiven(tranMatWithZeros)){
         loadTranMatWithZeros(tranMatWithZeros);    
-    }else if(tranMatElementwise.size()!=0){
+    }else if(isGiven(tranMatElementwise)){
         loadTranMatElementwise(tranMatElementwise);
     }else if(tranMatProbs.size()!=0&&tranMatColumns.size()!=0){
         problem.tranMat.assignProbsFromList(tranMatProbs);
         problem.tranMat.assignColumnsFromList(tranMatColumns);
     }else{
+        py::gil_scoped_release release;
         loadTranMatFromFile(tranMatFromFile,',',true);
     }
+    problem.tranMat.compressColumns(); //16-bit column indices where they save memory
 
 }
 
@@ -83,8 +132,12 @@ void ModuleInterface::tbm(double discount,
     double failureProb,
     double failureProbMin,
     double failureProbHat){
+    unique_lock<mutex> lock=lockModel();
     //selects the TBM problem
     problem.problemType="tbm";
+    problem.coloring.clear();
+    problem.graph.clear();
+    problem.partition.clear();
     settings.genMDP=false;
     problem.discount=discount;
     problem.components=components;
@@ -109,8 +162,12 @@ void ModuleInterface::cbm(double discount,
     double setupCost,
     double failurePenalty,
     int kOfN){
+    unique_lock<mutex> lock=lockModel();
     //selects the CBM problem
     problem.problemType="cbm";
+    problem.coloring.clear();
+    problem.graph.clear();
+    problem.partition.clear();
     settings.genMDP=false;
     problem.discount=discount;
     problem.components=components;
@@ -137,7 +194,21 @@ void ModuleInterface::solve(string algorithm,
                             bool verbose,
                             bool postProcessing,
                             bool makeFinalCheck,
-                            bool parallel){
+                            bool parallel,
+                            string evaluation,
+                            bool decompose,
+                            int andersonDepth,
+                            bool adaptiveParIter,
+                            bool adaptiveSOR,
+                            bool pinThreads,
+                            bool workStealing,
+                            bool mixedPrecision,
+                            bool actionElimination){
+    unique_lock<mutex> lock=lockModel();
+
+    //arrays returned by getPolicyArray and getValueVectorArray keep the results of the previous solve
+    detachResult(problem.policy.policy,results.policyKeeper);
+    detachResult(problem.valueVector.valueVector,results.valueVectorKeeper);
 
     //store solver settings
     settings.algorithm=algorithm;
@@ -150,17 +221,54 @@ void ModuleInterface::solve(string algorithm,
     settings.postProcessing=postProcessing;
     settings.makeFinalCheck=makeFinalCheck;
     settings.parallel=parallel;
+    settings.evaluation=evaluation;
+    settings.decompose=decompose;
+    settings.andersonDepth=andersonDepth;
+    settings.adaptiveParIter=adaptiveParIter;
+    settings.adaptiveSOR=adaptiveSOR;
+    settings.pinThreads=pinThreads;
+    settings.workStealing=workStealing;
+    settings.mixedPrecision=mixedPrecision;
+    settings.actionElimination=actionElimination;
     setInitPolicy(initPolicy);
     setInitValueVector(initValueVector);
 
+    //the solve only uses the C++ storage of the model, so other Python threads can run in the meantime
+    py::gil_scoped_release release;
+
+    //bind the threads to CPUs during the solve. The part of the transition matrix of each thread is moved to its NUMA node below.
+    bool pinned=false;
+    if (settings.parallel && settings.pinThreads){
+        pinned=NumaPlacement::pinThreads();
+        if (!pinned && settings.verbose){
+            cout << "The threads are not bound to CPUs, since another solve has bound its threads." << endl;
+        }
+    }
+
     //create and setup solver object
     ModifiedPolicyIteration solver(settings.tolerance, settings.algorithm,
     settings.update, settings.criterion, settings.parIterLim, settings.SORrelaxation, settings.verbose,
-    settings.postProcessing, settings.makeFinalCheck, settings.parallel, settings.genMDP);
+    settings.postProcessing, settings.makeFinalCheck, settings.parallel, settings.genMDP, settings.evaluation, settings.decompose, settings.andersonDepth, settings.adaptiveParIter, settings.adaptiveSOR, settings.workStealing, settings.mixedPrecision, settings.actionElimination);
+    solver.setColoring(&problem.coloring);
+    solver.setGraph(&problem.graph);
+    solver.setPartition(&problem.partition);
 
     //create model object
     if (problem.problemType.compare("mdp")==0){
         GeneralMDPmodel mdl(&problem.rewards,&problem.tranMat,problem.discount); //General MDP model
+        if (settings.mixedPrecision && !problem.tranMat.hasSinglePrecision()){
+            problem.tranMat.computeSinglePrecision(); //kept until a new model is selected
+            problem.placedThreads=0;
+        }
+        if (settings.parallel && NumaPlacement::numberOfNodes()>1 && (problem.placedThreads!=omp_get_max_threads() || problem.placedPinned!=pinned)){
+            //the threads process the chunks of the partition (see WorkPartition)
+            if (problem.partition.empty()){
+                problem.partition.compute(&mdl);
+            }
+            problem.tranMat.place(NumaPlacement::threadStates(problem.partition.improvementChunks));
+            problem.placedThreads=omp_get_max_threads();
+            problem.placedPinned=pinned; //bound threads run on the same CPUs in every solve
+        }
         solver.solve(&mdl,&problem.policy,&problem.valueVector);
     }else if (problem.problemType.compare("tbm")==0){
         TBMmodel mdl(problem.discount, //Time-based maintenance model
@@ -186,9 +294,14 @@ void ModuleInterface::solve(string algorithm,
         problem.kOfN);
         solver.solve(&mdl,&problem.policy,&problem.valueVector);
     }
+    if (pinned){
+        NumaPlacement::unpinThreads();
+    }
 
     //save duration (runtime) in milliseconds
     results.duration=solver.duration;
+    results.parIterLims=solver.parIterLims;
+    results.SORrelaxation=solver.finalRelaxation;
         
 }
 
@@ -216,15 +329,133 @@ void ModuleInterface::setInitValueVector(py::list initValueVector){
     }    
 }
 
+unique_lock<mutex> ModuleInterface::lockModel(){
+    //the GIL is released while another thread solves this model, which needs it again at the end
+    unique_lock<mutex> lock(modelMutex,try_to_lock);
+    if (!lock.owns_lock()){
+        py::gil_scoped_release release;
+        lock.lock();
+    }
+    return lock;
+}
+
 py::list ModuleInterface::getPolicy(){
+    unique_lock<mutex> lock=lockModel();
     return(py::cast(problem.policy.policy));
 }
 
 py::list ModuleInterface::getValueVector(){
+    unique_lock<mutex> lock=lockModel();
     return(py::cast(problem.valueVector.valueVector));
 }
 
+template <class T>
+py::array ModuleInterface::viewResult(vector<T> &values, shared_ptr<vector<T>> &keeper){
+    //the array views the buffer of values and keeps the model alive. If the array still exists when
+    //the next solve starts, the buffer is handed over to keeper (see detachResult), which the array
+    //also holds, so the array stays valid and keeps its values.
+    if (!keeper){
+        keeper=make_shared<vector<T>>();
+    }
+    py::capsule owner(new shared_ptr<vector<T>>(keeper),[](void * p){ delete (shared_ptr<vector<T>> *)p; });
+    py::tuple base=py::make_tuple(py::cast(this,py::return_value_policy::reference),owner);
+    py::array_t<T> array(values.size(),values.data(),base);
+    array.attr("flags").attr("writeable")=false;
+    return array;
+}
+
+template <class T>
+void ModuleInterface::detachResult(vector<T> &values, shared_ptr<vector<T>> &keeper){
+    //called before the results are changed. Arrays that view values get the current buffer,
+    //and the solver continues with a copy.
+    if (keeper && keeper.use_count()>1){
+        keeper->swap(values);
+        values=*keeper;
+    }
+    keeper.reset();
+}
+
+py::array ModuleInterface::getPolicyArray(){
+    unique_lock<mutex> lock=lockModel();
+    return viewResult(problem.policy.policy,results.policyKeeper);
+}
+
+py::array ModuleInterface::getValueVectorArray(){
+    unique_lock<mutex> lock=lockModel();
+    return viewResult(problem.valueVector.valueVector,results.valueVectorKeeper);
+}
+
+py::array ModuleInterface::getActions(py::array_t<long long, py::array::c_style | py::array::forcecast> stateIndices){
+    unique_lock<mutex> lock=lockModel();
+    py::array_t<int> actions(stateIndices.size());
+    const long long * states=stateIndices.data();
+    int * result=actions.mutable_data();
+    const vector<int> &policy=problem.policy.policy;
+    long long numberOfStates=policy.size();
+    for (long long i=0; i<stateIndices.size(); i++){
+        result[i] = states[i]>=0 && states[i]<numberOfStates ? policy[states[i]] : -1;
+    }
+    return actions.reshape(vector<py::ssize_t>(stateIndices.shape(),stateIndices.shape()+stateIndices.ndim()));
+}
+
+py::list ModuleInterface::getParIterLims(){
+    unique_lock<mutex> lock=lockModel();
+    return(py::cast(results.parIterLims));
+}
+
+double ModuleInterface::getSORrelaxation(){
+    unique_lock<mutex> lock=lockModel();
+    return(results.SORrelaxation);
+}
+
+static py::list rowPairs(ModelType &mdl, int sidx, int aidx){
+    //the pairs in the order the solver reads them from getRow
+    py::list pairs;
+    if (sidx<0 || sidx>=mdl.getNumberOfStates() || aidx<0 || aidx>=mdl.getNumberOfActions(sidx)){
+        return pairs;
+    }
+    RowBuffer buf;
+    TransitionRow row=mdl.getRow(sidx,aidx,buf);
+    for (int cidx=0; cidx<row.length; cidx++){
+        pairs.append(py::make_tuple(row.cols[cidx],row.probs[cidx]));
+    }
+    return pairs;
+}
+
+py::list ModuleInterface::getTransitionRow(int sidx, int aidx){
+    unique_lock<mutex> lock=lockModel();
+    if (problem.problemType.compare("mdp")==0){
+        GeneralMDPmodel mdl(&problem.rewards,&problem.tranMat,problem.discount);
+        return rowPairs(mdl,sidx,aidx);
+    }else if (problem.problemType.compare("tbm")==0){
+        TBMmodel mdl(problem.discount,
+        problem.components,
+        problem.stages,
+        problem.replacementCost,
+        problem.setupCost,
+        problem.unexpectedFailureCost,
+        problem.expiredNotFixedCost,
+        problem.failureProb,
+        problem.failureProbMin,
+        problem.failureProbHat);
+        return rowPairs(mdl,sidx,aidx);
+    }else if (problem.problemType.compare("cbm")==0){
+        CBMmodel mdl(problem.discount,
+        problem.components,
+        problem.stages,
+        problem.pCompMat,
+        problem.preventiveCost,
+        problem.correctiveCost,
+        problem.setupCost,
+        problem.failurePenalty,
+        problem.kOfN);
+        return rowPairs(mdl,sidx,aidx);
+    }
+    return py::list();
+}
+
 int ModuleInterface::getAction(int sidx){
+    unique_lock<mutex> lock=lockModel();
     if (sidx>=0 && sidx<problem.policy.policy.size()){
         return(problem.policy.policy[sidx]);
     }else{
@@ -233,6 +464,7 @@ int ModuleInterface::getAction(int sidx){
 }
 
 double ModuleInterface::getValue(int sidx){
+    unique_lock<mutex> lock=lockModel();
     if (sidx>=0 && sidx<problem.valueVector.valueVector.size()){
         return(problem.valueVector.valueVector[sidx]);
     }else{
@@ -241,18 +473,21 @@ double ModuleInterface::getValue(int sidx){
 }
 
 void ModuleInterface::printPolicy(){
+    unique_lock<mutex> lock=lockModel();
     for (int sidx=0; sidx<problem.policy.policy.size(); sidx++){
         cout << sidx << ": " << problem.policy.policy[sidx] << endl; 
     }
 }
 
 void ModuleInterface::printValueVector(){
+    unique_lock<mutex> lock=lockModel();
     for (int sidx=0; sidx<problem.valueVector.valueVector.size(); sidx++){
         cout << sidx << ": " << problem.valueVector.valueVector[sidx] << endl; 
     }
 }
 
 void ModuleInterface::saveToFile(string fileName, string type){
+    unique_lock<mutex> lock=lockModel();
     if (type.compare("policy")==0 || type.compare("p")==0){
         savePolicyToFile(fileName,',');    
     }else if(type.compare("values")==0 || type.compare("v")==0){
@@ -260,6 +495,15 @@ void ModuleInterface::saveToFile(string fileName, string type){
     }
 }
 
+void ModuleInterface::saveModel(string fileName){
+    unique_lock<mutex> lock=lockModel();
+    if (problem.problemType.compare("mdp")!=0){
+        cerr << "Error: Only the general MDP model can be saved to a model file." << endl;
+        return;
+    }
+    ModelFile::write(fileName,problem.tranMat,problem.rewards);
+}
+
 void ModuleInterface::savePolicyToFile(string fileName, char sep){
     ofstream outFile(fileName);
     if (!outFile.is_open()) {
@@ -287,10 +531,58 @@ void ModuleInterface::saveValueVectorToFile(string fileName, char sep){
 }
 
 double ModuleInterface::getRuntime(){
+    unique_lock<mutex> lock=lockModel();
     return(results.duration);
 }
 
-void ModuleInterface::loadTranMatWithZeros(py::list tranMatWithZeros){
+void ModuleInterface::loadRewards(py::object rewards){
+    if (py::isinstance<py::list>(rewards)){
+        problem.rewards.assignRewardsFromList(rewards);
+        return;
+    }
+    //2D array (state, action), which is used without copying
+    DoubleArray array = DoubleArray::ensure(rewards);
+    if (!array || array.ndim()!=2){
+        cerr << "Error: rewards must be a 2D-list or a 2D NumPy array." << endl;
+        return;
+    }
+    problem.externalArrays.append(array);
+    problem.rewards.assignExternalRewards(array.data(),array.shape(0),array.shape(1));
+}
+
+void ModuleInterface::loadTranMatWithZeros(py::object tranMatWithZeros){
+    if (!py::isinstance<py::list>(tranMatWithZeros)){
+        //3D array (state, action, next state)
+        DoubleArray array = DoubleArray::ensure(tranMatWithZeros);
+        if (!array || array.ndim()!=3 || array.shape(0)!=array.shape(2)){
+            cerr << "Error: tranMatWithZeros must be a 3D-list or a 3D NumPy array with the same number of states in the first and last dimension." << endl;
+            return;
+        }
+        auto probs = array.unchecked<3>();
+        int numberOfStates = array.shape(0), nActions = array.shape(1), cidx;
+        problem.tranMat.setNumberOfRows(numberOfStates);
+        for (int sidx=0; sidx<numberOfStates; sidx++){
+            problem.tranMat.setNumberOfActions(nActions,sidx);
+            for (int aidx=0; aidx<nActions; aidx++){
+                cidx=0;
+                for (int jidx=0; jidx<numberOfStates; jidx++){
+                    if (probs(sidx,aidx,jidx)>0.0){
+                        cidx++;
+                    }
+                }
+                problem.tranMat.setNumberOfColumns(cidx,sidx,aidx);
+                cidx=0;
+                for (int jidx=0; jidx<numberOfStates; jidx++){
+                    if (probs(sidx,aidx,jidx)>0.0){
+                        problem.tranMat.assignColumn(jidx,sidx,aidx,cidx);
+                        problem.tranMat.assignProb(probs(sidx,aidx,jidx),sidx,aidx,cidx);
+                        cidx++;
+                    }
+                }
+            }
+        }
+        return;
+    }
         vector<vector<vector<double>>> tempMat = tranMatWithZeros.cast<vector<vector<vector<double>>>>();
         int cidx;
         problem.tranMat.setNumberOfRows(tempMat.size());
@@ -316,303 +608,229 @@ void ModuleInterface::loadTranMatWithZeros(py::list tranMatWithZeros){
         }
 }
 
-void ModuleInterface::loadRewardsElementwise(py::list rewardsElementwise){
-
-    py::list innerRew;
-    vector<int> nAct;
-    int k0,k1;
-    double r;
-    int numberOfStates=0;
-    //determine number of States
-    for (int i=0; i<rewardsElementwise.size(); i++){
-        innerRew = rewardsElementwise[i].cast<py::list>();
-        k0 = innerRew[0].cast<int>();
-        if (k0>numberOfStates){
-            numberOfStates=k0;
+void ModuleInterface::loadRewardsElementwise(py::object rewardsElementwise){
+    vector<int> states, actions;
+    vector<double> values;
+    if (py::isinstance<py::list>(rewardsElementwise)){
+        py::list list = rewardsElementwise, element;
+        states.resize(list.size()); actions.resize(list.size()); values.resize(list.size());
+        for (int i=0; i<list.size(); i++){
+            element = list[i].cast<py::list>();
+            states[i] = element[0].cast<int>(); actions[i] = element[1].cast<int>();
+            values[i] = element[2].cast<double>();
         }
-    }       
-    numberOfStates++;
-    nAct.resize(numberOfStates,0);
-    //determine number of actions in each state
-    for (int i=0; i<rewardsElementwise.size(); i++){
-        innerRew = rewardsElementwise[i].cast<py::list>();
-        k0 = innerRew[0].cast<int>(); k1 = innerRew[1].cast<int>();
-        if (k1>nAct[k0]){
-            nAct[k0]=k1;
+    }else{
+        //2D array with the columns state, action, reward
+        DoubleArray array = DoubleArray::ensure(rewardsElementwise);
+        if (!array || array.ndim()!=2 || array.shape(1)<3){
+            cerr << "Error: rewardsElementwise must be a 2D-list or a 2D NumPy array with 3 columns." << endl;
+            return;
+        }
+        auto elements = array.unchecked<2>();
+        states.resize(array.shape(0)); actions.resize(array.shape(0)); values.resize(array.shape(0));
+        for (long long i=0; i<array.shape(0); i++){
+            states[i] = elements(i,0); actions[i] = elements(i,1);
+            values[i] = elements(i,2);
         }
     }
-    //allocate memory
-    problem.rewards.setNumberOfRows(numberOfStates);
-    for (int sidx=0; sidx<numberOfStates; sidx++){
-        problem.rewards.setNumberOfActions((nAct[sidx]+1),sidx);
-    }    
-    //assign values
-    for (int i=0; i<rewardsElementwise.size(); i++){
-        innerRew = rewardsElementwise[i].cast<py::list>();
-        k0 = innerRew[0].cast<int>(); k1 = innerRew[1].cast<int>();
-        r = innerRew[2].cast<double>();
-        problem.rewards.assignReward(r,k0,k1);
-    }
+    assignRewards(states,actions,values);
 }
 
 void ModuleInterface::loadRewardsFromFile(string rewardsFromFile, char sep, bool header){
-
-    string line,cell;
-    vector<int> nAct;
-    int i,k0,k1;
-    double r;
-    int numberOfStates=0;
-
-    //determine number of states
-    ifstream file(rewardsFromFile);
-    if (!file.is_open()) {
-        cerr << "Error: Unable to open " << rewardsFromFile << endl;
+    //lines: state,action,reward
+    CsvReader file;
+    if (!file.read(rewardsFromFile,sep,header,2,1)){
         return;
     }
-    i=0;
-    while (getline(file,line)){
-        if (!header||i>0){
-            stringstream lineStream(line);
-            vector<string> innerRew;
-            while (getline(lineStream,cell,sep)) {
-                innerRew.push_back(cell);
-            }
-            k0 = stoi(innerRew[0]);
-            if (k0>numberOfStates){
-                numberOfStates=k0;
-            }
-        }
-        i++;
-    }
-    numberOfStates++;    
-    nAct.resize(numberOfStates,0);
-    
-    //reset
-    file.clear();
-    file.seekg(0,ios::beg);
-
-    //determine number of actions in each state
-    i=0;
-    while (getline(file,line)){
-        if (!header||i>0){
-            stringstream lineStream(line);
-            vector<string> innerRew;
-            while (getline(lineStream,cell,sep)) {
-                innerRew.push_back(cell); 
-                
-            }
-            k0 = stoi(innerRew[0]); k1 = stoi(innerRew[1]);
-            if (k1>nAct[k0]){
-                nAct[k0]=k1;
-            }    
+    assignRewards(file.indices[0],file.indices[1],file.values[0]);
+}
+
+void ModuleInterface::assignRewards(const vector<int> &states, const vector<int> &actions, const vector<double> &values){
+    //the number of actions of a state is given by its largest action index.
+    //rewards that are not given are -1.
+    int numberOfStates=0;
+    for (size_t i=0; i<states.size(); i++){
+        if (states[i]<0 || actions[i]<0){
+            cerr << "Error: Negative state or action index in the rewards." << endl;
+            return;
         }
-        i++;
+        numberOfStates=max(numberOfStates,states[i]+1);
+    }
+    vector<int> nAct(numberOfStates,1);
+    for (size_t i=0; i<states.size(); i++){
+        nAct[states[i]]=max(nAct[states[i]],actions[i]+1);
     }
-    
-    //reset
-    file.clear();
-    file.seekg(0,ios::beg);
-
-    //allocate memory
     problem.rewards.setNumberOfRows(numberOfStates);
     for (int sidx=0; sidx<numberOfStates; sidx++){
-        problem.rewards.setNumberOfActions((nAct[sidx]+1),sidx);
+        problem.rewards.setNumberOfActions(nAct[sidx],sidx);
     }
-
-    //assign values
-    i=0;
-    while (getline(file,line)){
-        if (!header||i>0){
-            stringstream lineStream(line);
-            vector<string> innerRew;
-            while (getline(lineStream,cell,sep)) {
-                innerRew.push_back(cell);
-            }
-            k0 = stoi(innerRew[0]); k1 = stoi(innerRew[1]);
-            r = stod(innerRew[2]);
-            problem.rewards.assignReward(r,k0,k1);    
-        }
-        i++;
+    for (size_t i=0; i<states.size(); i++){
+        int sidx=states[i], aidx=actions[i];
+        problem.rewards.assignReward(values[i],sidx,aidx);
     }
-    file.close();
 }
 
-void ModuleInterface::loadTranMatElementwise(py::list tranMatElementwise){
-
-    py::list innerRew;
-    vector<int> nAct;
-    vector<vector<int>> nCol;
-    int k0,k1,k2,cidx;
-    double prob;
-    int numberOfStates=0;
-    //determine number of States
-    for (int i=0; i<tranMatElementwise.size(); i++){
-        innerRew = tranMatElementwise[i].cast<py::list>();
-        k0 = innerRew[0].cast<int>();
-        if (k0>numberOfStates){
-            numberOfStates=k0;
+void ModuleInterface::loadTranMatElementwise(py::object tranMatElementwise){
+    vector<int> states, actions, nextStates;
+    vector<double> probs;
+    if (py::isinstance<py::list>(tranMatElementwise)){
+        py::list list = tranMatElementwise, element;
+        states.resize(list.size()); actions.resize(list.size()); nextStates.resize(list.size()); probs.resize(list.size());
+        for (int i=0; i<list.size(); i++){
+            element = list[i].cast<py::list>();
+            states[i] = element[0].cast<int>(); actions[i] = element[1].cast<int>();
+            nextStates[i] = element[2].cast<int>(); probs[i] = element[3].cast<double>();
         }
-    }       
-    numberOfStates++;
-    nAct.resize(numberOfStates,0);
-    nCol.resize(numberOfStates);
-    //determine number of actions and columns (next states) in each state
-    for (int i=0; i<tranMatElementwise.size(); i++){
-        innerRew = tranMatElementwise[i].cast<py::list>();
-        k0 = innerRew[0].cast<int>(); k1 = innerRew[1].cast<int>();
-        if (k1>nAct[k0]){
-            nAct[k0]=k1;
-        }
-    }
-    for (int sidx=0; sidx<numberOfStates; sidx++){
-        nCol[sidx].resize((nAct[sidx]+1),0);
-    }
-    for (int i=0; i<tranMatElementwise.size(); i++){
-        innerRew = tranMatElementwise[i].cast<py::list>();
-        k0 = innerRew[0].cast<int>(); k1 = innerRew[1].cast<int>();
-        k2 = innerRew[2].cast<int>();
-        if (k2>nCol[k0][k1]){
-            nCol[k0][k1]=k2;
-        }
-    }
-    //allocate memory
-    problem.tranMat.setNumberOfRows(numberOfStates);
-    for (int sidx=0; sidx<numberOfStates; sidx++){
-        problem.tranMat.setNumberOfActions((nAct[sidx]+1),sidx);
-        for (int aidx=0; aidx<(nAct[sidx]+1); aidx++){
-            problem.tranMat.setNumberOfColumns((nCol[sidx][aidx]+1),sidx,aidx);           
+    }else{
+        //2D array with the columns state, action, next state, probability
+        DoubleArray array = DoubleArray::ensure(tranMatElementwise);
+        if (!array || array.ndim()!=2 || array.shape(1)<4){
+            cerr << "Error: tranMatElementwise must be a 2D-list or a 2D NumPy array with 4 columns." << endl;
+            return;
         }
-    }    
-    //assign values
-    for (int i=0; i<tranMatElementwise.size(); i++){
-        innerRew = tranMatElementwise[i].cast<py::list>();
-        k0 = innerRew[0].cast<int>(); k1 = innerRew[1].cast<int>();
-        k2 = innerRew[2].cast<int>(); prob = innerRew[3].cast<double>();
-        //find cidx
-        cidx=0;
-        while (problem.tranMat.getColumn(k0,k1,cidx)!=-1){
-            cidx++;
+        auto elements = array.unchecked<2>();
+        long long n = array.shape(0);
+        states.resize(n); actions.resize(n); nextStates.resize(n); probs.resize(n);
+        #pragma omp parallel for
+        for (long long i=0; i<n; i++){
+            states[i] = elements(i,0); actions[i] = elements(i,1);
+            nextStates[i] = elements(i,2); probs[i] = elements(i,3);
         }
-        problem.tranMat.assignColumn(k2,k0,k1,cidx);
-        problem.tranMat.assignProb(prob,k0,k1,cidx);
     }
+    assignTranMat(states,actions,nextStates,probs);
 }
 
-
-void ModuleInterface::loadTranMatFromFile(string tranMatFromFile, char sep, bool header){
-    
-    string line,cell;
-    vector<int> nAct;
-    vector<vector<int>> nCol;
-    int i,k0,k1,k2,cidx;
-    double prob;
-    int numberOfStates=0;
-
-   //determine number of States
-   ifstream file(tranMatFromFile);
-    if (!file.is_open()) {
-        cerr << "Error: Unable to open " << tranMatFromFile << endl;
-        return;
-    }
-    i=0;
-    while (getline(file,line)){
-        if (!header||i>0){
-            stringstream lineStream(line);
-            vector<string> innerRew;
-            while (getline(lineStream,cell,sep)) {
-                innerRew.push_back(cell);
+void ModuleInterface::loadTranMatSparse(py::object tranMatSparse){
+    //SciPy sparse matrices in CSR format, or in a format that can be converted with tocsr (e.g. COO)
+    if (py::isinstance<py::list>(tranMatSparse)){
+        //one (states x states) matrix per action. The rows are copied in the order of the states.
+        py::list matrices = tranMatSparse;
+        int nActions = matrices.size(), numberOfStates = -1;
+        vector<DoubleArray> data(nActions);
+        vector<IntArray> indices(nActions);
+        vector<OffsetArray> indptr(nActions);
+        for (int aidx=0; aidx<nActions; aidx++){
+            if (!py::hasattr(matrices[aidx],"tocsr")){
+                cerr << "Error: tranMatSparse must be a SciPy sparse matrix or a list of SciPy sparse matrices." << endl;
+                return;
+            }
+            py::object csr = matrices[aidx].attr("tocsr")();
+            py::tuple shape = csr.attr("shape");
+            if (numberOfStates<0){
+                numberOfStates = shape[0].cast<int>();
+            }
+            if (shape[0].cast<int>()!=numberOfStates || shape[1].cast<int>()!=numberOfStates){
+                cerr << "Error: The matrices of all actions in tranMatSparse must have the shape (states, states)." << endl;
+                return;
             }
-            k0 = stoi(innerRew[0]);
-            if (k0>numberOfStates){
-                numberOfStates=k0;
+            data[aidx] = DoubleArray::ensure(csr.attr("data"));
+            indices[aidx] = IntArray::ensure(csr.attr("indices"));
+            indptr[aidx] = OffsetArray::ensure(csr.attr("indptr"));
+            if (!validColumns(indices[aidx].data(),indices[aidx].size(),numberOfStates)){
+                return;
             }
         }
-        i++;
-    }
-    numberOfStates++;
-    nAct.resize(numberOfStates,0);
-    nCol.resize(numberOfStates);
-
-    //reset
-    file.clear();
-    file.seekg(0,ios::beg);
-
-    //determine number of actions and columns (next states) in each state
-    i=0;
-    while (getline(file,line)){
-        if (!header||i>0){
-            stringstream lineStream(line);
-            vector<string> innerRew;
-            while (getline(lineStream,cell,sep)) {
-                innerRew.push_back(cell); 
-                
+        problem.tranMat.setNumberOfRows(numberOfStates);
+        for (int sidx=0; sidx<numberOfStates; sidx++){
+            problem.tranMat.setNumberOfActions(nActions,sidx);
+            for (int aidx=0; aidx<nActions; aidx++){
+                const long long * offsets = indptr[aidx].data();
+                problem.tranMat.setNumberOfColumns(offsets[sidx+1]-offsets[sidx],sidx,aidx);
+                for (int cidx=0; cidx<offsets[sidx+1]-offsets[sidx]; cidx++){
+                    problem.tranMat.assignColumn(indices[aidx].data()[offsets[sidx]+cidx],sidx,aidx,cidx);
+                    problem.tranMat.assignProb(data[aidx].data()[offsets[sidx]+cidx],sidx,aidx,cidx);
+                }
             }
-            k0 = stoi(innerRew[0]); k1 = stoi(innerRew[1]);
-            if (k1>nAct[k0]){
-                nAct[k0]=k1;
-            }    
         }
-        i++;
+        return;
     }
-    for (int sidx=0; sidx<numberOfStates; sidx++){
-        nCol[sidx].resize((nAct[sidx]+1),0);
+
+    //a single (states*actions x states) matrix, whose row sidx*nActions+aidx is for state sidx and action aidx.
+    //the probabilities and column indices are used without copying.
+    if (!py::hasattr(tranMatSparse,"tocsr")){
+        cerr << "Error: tranMatSparse must be a SciPy sparse matrix or a list of SciPy sparse matrices." << endl;
+        return;
+    }
+    py::object csr = tranMatSparse.attr("tocsr")();
+    py::tuple shape = csr.attr("shape");
+    long long nRows = shape[0].cast<long long>();
+    int numberOfStates = shape[1].cast<int>();
+    if (numberOfStates==0 || nRows%numberOfStates!=0){
+        cerr << "Error: The number of rows of tranMatSparse must be a multiple of the number of states (columns)." << endl;
+        return;
     }
+    int nActions = nRows/numberOfStates;
+    DoubleArray data = DoubleArray::ensure(csr.attr("data"));
+    IntArray indices = IntArray::ensure(csr.attr("indices"));
+    OffsetArray indptr = OffsetArray::ensure(csr.attr("indptr"));
+    if (!validColumns(indices.data(),indices.size(),numberOfStates)){
+        return;
+    }
+    vector<long long> rowOffsets(indptr.data(),indptr.data()+nRows+1);
+    vector<int> actionOffsets(numberOfStates+1);
+    for (int sidx=0; sidx<=numberOfStates; sidx++){
+        actionOffsets[sidx]=sidx*nActions;
+    }
+    problem.externalArrays.append(data);
+    problem.externalArrays.append(indices);
+    problem.tranMat.assignExternalRows(data.data(),indices.data(),rowOffsets,actionOffsets);
+}
 
-    //reset
-    file.clear();
-    file.seekg(0,ios::beg);
+void ModuleInterface::loadTranMatFromFile(string tranMatFromFile, char sep, bool header){
+    //lines: state,action,next state,probability
+    CsvReader file;
+    if (!file.read(tranMatFromFile,sep,header,3,1)){
+        return;
+    }
+    assignTranMat(file.indices[0],file.indices[1],file.indices[2],file.values[0]);
+}
 
-    i=0;
-    while (getline(file,line)){
-        if (!header||i>0){
-            stringstream lineStream(line);
-            vector<string> innerRew;
-            while (getline(lineStream,cell,sep)) {
-                innerRew.push_back(cell); 
-                
-            }
-            k0 = stoi(innerRew[0]); k1 = stoi(innerRew[1]);
-            k2 = stoi(innerRew[2]);
-            if (k2>nCol[k0][k1]){
-                nCol[k0][k1]=k2;
-            }    
-        }
-        i++;
+void ModuleInterface::assignTranMat(const vector<int> &states, const vector<int> &actions, const vector<int> &nextStates, const vector<double> &probs){
+    //builds the CSR storage with a counting sort of the elements by row (state,action).
+    //the elements of a row keep their order in the input.
+    long long n=states.size();
+    int numberOfStates=0, maxNextState=0;
+    bool negative=false;
+    #pragma omp parallel for reduction(max:numberOfStates,maxNextState) reduction(||:negative)
+    for (long long i=0; i<n; i++){
+        negative = negative || states[i]<0 || actions[i]<0 || nextStates[i]<0;
+        numberOfStates=max(numberOfStates,states[i]+1);
+        maxNextState=max(maxNextState,nextStates[i]);
+    }
+    if (negative || maxNextState>=numberOfStates){
+        cerr << "Error: The transition probabilities contain a state or action index that is negative or larger than the largest state." << endl;
+        return;
     }
 
-    //reset
-    file.clear();
-    file.seekg(0,ios::beg);
+    //number of actions of each state (given by its largest action index) and number of elements of each row
+    vector<int> nAct(numberOfStates,1);
+    for (long long i=0; i<n; i++){
+        nAct[states[i]]=max(nAct[states[i]],actions[i]+1);
+    }
+    vector<int> firstRow(numberOfStates+1,0);
+    for (int sidx=0; sidx<numberOfStates; sidx++){
+        firstRow[sidx+1]=firstRow[sidx]+nAct[sidx];
+    }
+    vector<int> nCol(firstRow.back(),0);
+    for (long long i=0; i<n; i++){
+        nCol[firstRow[states[i]]+actions[i]]++;
+    }
 
     //allocate memory
     problem.tranMat.setNumberOfRows(numberOfStates);
     for (int sidx=0; sidx<numberOfStates; sidx++){
-        problem.tranMat.setNumberOfActions((nAct[sidx]+1),sidx);
-        for (int aidx=0; aidx<(nAct[sidx]+1); aidx++){
-            problem.tranMat.setNumberOfColumns((nCol[sidx][aidx]+1),sidx,aidx);           
+        problem.tranMat.setNumberOfActions(nAct[sidx],sidx);
+        for (int aidx=0; aidx<nAct[sidx]; aidx++){
+            problem.tranMat.setNumberOfColumns(nCol[firstRow[sidx]+aidx],sidx,aidx);
         }
     }
 
     //assign values
-    i=0;
-    while (getline(file,line)){
-        if (!header||i>0){
-            stringstream lineStream(line);
-            vector<string> innerRew;
-            while (getline(lineStream,cell,sep)) {
-                innerRew.push_back(cell);
-            }
-            k0 = stoi(innerRew[0]); k1 = stoi(innerRew[1]);
-            k2 = stoi(innerRew[2]); prob = stod(innerRew[3]);
-            //find cidx
-            cidx=0;
-            while (problem.tranMat.getColumn(k0,k1,cidx)!=-1){
-                cidx++;
-            }
-            problem.tranMat.assignColumn(k2,k0,k1,cidx);
-            problem.tranMat.assignProb(prob,k0,k1,cidx);
-        }
-        i++;
+    fill(nCol.begin(),nCol.end(),0); //elements assigned to each row so far
+    for (long long i=0; i<n; i++){
+        int sidx=states[i], aidx=actions[i];
+        int cidx=nCol[firstRow[sidx]+aidx]++;
+        problem.tranMat.assignColumn(nextStates[i],sidx,aidx,cidx);
+        problem.tranMat.assignProb(probs[i],sidx,aidx,cidx);
     }
-    file.close();
-}
\ No newline at end of file
+}
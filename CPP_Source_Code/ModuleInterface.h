@@ -24,14 +24,23 @@
 
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <pybind11/numpy.h>
 #include <vector>
 #include <string>
 #include <iostream>
+#include <memory>
+#include <mutex>
 
 #include "ModelType.h" //Generic model class
 #include "ModifiedPolicyIteration.h" //The solver
 #include "TransitionMatrix.h" //Stores transition matrix in general MDP model
 #include "Rewards.h" //Stores rewards in general MDP model
+#include "ModelFile.h" //Binary model file that the transition matrix and rewards are mapped from
+#include "CsvReader.h" //Parallel parser of the rewards and transition probability files
+#include "StateColoring.h" //Ordering of the states for parallel GS/SOR updates
+#include "StateGraph.h" //Predecessors of the states for prioritized sweeping
+#include "WorkPartition.h" //Chunks of states with equal work for parallel standard updates
+#include "NumaPlacement.h" //Placement of the transition matrix on the NUMA nodes
 
 //MODEL TYPES
 #include "GeneralMDPmodel.h" //General MDP model
@@ -70,6 +79,29 @@ public:
         //transition matrix and rewards (only for general MDP model)
         TransitionMatrix tranMat;
         Rewards rewards;
+
+        //mapped model file that tranMat and rewards point into (only if the model is loaded with modelFromFile)
+        ModelFile modelFile;
+
+        //NumPy arrays that tranMat and rewards point into. Kept alive until a new model is selected.
+        py::list externalArrays;
+
+        //coloring of the states (only for parallel GS/SOR updates). Computed
+        //at the first such solve and reused until a new model is selected.
+        StateColoring coloring;
+
+        //transition graph of the states (only for prioritized sweeping). Computed
+        //at the first such solve and reused until a new model is selected.
+        StateGraph graph;
+
+        //chunks of states with equal work (only for parallel standard updates). Computed
+        //at the first such solve and reused until a new model is selected.
+        WorkPartition partition;
+
+        //number of threads the transition matrix is distributed over on the NUMA nodes
+        //(only for parallel solves). 0 until the first such solve of the model.
+        int placedThreads=0;
+        bool placedPinned=false; //the threads were bound to CPUs when the matrix was distributed
     
         //only for the TBM/CBM models
         int components;
@@ -102,6 +134,15 @@ public:
         bool makeFinalCheck;
         bool parallel;
         bool genMDP;
+        string evaluation;
+        bool decompose;
+        int andersonDepth;
+        bool adaptiveParIter;
+        bool adaptiveSOR;
+        bool pinThreads;
+        bool workStealing;
+        bool mixedPrecision;
+        bool actionElimination;
     } settings;
 
 
@@ -109,6 +150,13 @@ public:
     struct Results{
         //duration (runtime) in milliseconds
         double duration=0;
+        //partial evaluation limit of each iteration (adaptive MPI only)
+        vector<int> parIterLims;
+        //SOR relaxation at the end of the solve (chosen by adaptive SOR)
+        double SORrelaxation=1.0;
+        //owners of the policy and value vector buffers viewed by NumPy arrays (see viewResult)
+        shared_ptr<vector<int>> policyKeeper;
+        shared_ptr<vector<double>> valueVectorKeeper;
     } results;
 
     
@@ -119,15 +167,18 @@ public:
     //------ problem selection ------
 
     //the general MDP problem
+    //the list options also accept NumPy arrays (rewards, rewardsElementwise, tranMatWithZeros, tranMatElementwise)
     void mdp(double discount,
-    py::list rewards, //option1: complete reward list 
-    py::list rewardsElementwise, //option2: rewards where each row is an element and columns specify sidx,aidx,reward
+    py::object rewards, //option1: complete reward list 
+    py::object rewardsElementwise, //option2: rewards where each row is an element and columns specify sidx,aidx,reward
     string rewardsFromFile, //option3: rewards are loaded from a file
-    py::list tranMatWithZeros, //option1: complete transition mat incl. zeros
-    py::list tranMatElementwise, //option2: tran mat where each row is a non-zero element and columns specify sidx,aidx,jidx,prob
+    py::object tranMatWithZeros, //option1: complete transition mat incl. zeros
+    py::object tranMatElementwise, //option2: tran mat where each row is a non-zero element and columns specify sidx,aidx,jidx,prob
     py::list tranMatProbs, //option3a: transition mat non-zero probabilities
     py::list tranMatColumns, //option3b: transition mat column indices 
-    string tranMatFromFile); //option4: transition mat is loaded from a file
+    string tranMatFromFile, //option4: transition mat is loaded from a file
+    string modelFromFile, //alternative to all of the above: rewards and transition mat are mapped from a binary model file
+    py::object tranMatSparse); //option5: tran mat as SciPy sparse matrices (stacked, or one per action)
 
     // ------ pre-defined MDP problems ------  
     void tbm(double discount, //select TBM problem
@@ -163,7 +214,16 @@ public:
      bool verbose=false,
      bool postProcessing=true,
      bool makeFinalCheck=true,
-     bool parallel=true); 
+     bool parallel=true,
+     string evaluation="iterative",
+     bool decompose=false,
+     int andersonDepth=0,
+     bool adaptiveParIter=false,
+     bool adaptiveSOR=false,
+     bool pinThreads=false,
+     bool workStealing=false,
+     bool mixedPrecision=false,
+     bool actionElimination=true); 
     
     //-------------------------------
 
@@ -176,18 +236,35 @@ public:
     double getRuntime(); //returns the runtime in milliseconds
     py::list getPolicy(); //returns the entire policy
     py::list getValueVector(); //returns the entire value vector
+    py::array getPolicyArray(); //returns the policy as a read-only NumPy array without copying it
+    py::array getValueVectorArray(); //returns the value vector as a read-only NumPy array without copying it
+    py::array getActions(py::array_t<long long, py::array::c_style | py::array::forcecast> stateIndices); //returns the actions of several states (-1 for invalid states)
+    py::list getParIterLims(); //returns the partial evaluation limits chosen by adaptive MPI
+    double getSORrelaxation(); //returns the SOR relaxation used at the end of the solve
+    py::list getTransitionRow(int sidx, int aidx); //returns the (column, probability) pairs of a row of the transition matrix
     void saveToFile(string fileName, string type); //save the policy or value vector to a file 
+    void saveModel(string fileName); //save the general MDP model to a binary model file (see ModelFile)
 
 private:
 
+    //VARIABLES
+    mutex modelMutex; //held during the calls that use the model, so that one model is not used by two threads at once
+
     //METHODS
+    unique_lock<mutex> lockModel(); //waits until no other thread uses the model
+    template <class T> py::array viewResult(vector<T> &values, shared_ptr<vector<T>> &keeper);
+    template <class T> void detachResult(vector<T> &values, shared_ptr<vector<T>> &keeper);
     void setInitPolicy(py::list initPolicy);
     void setInitValueVector(py::list initValueVector);
-    void loadTranMatWithZeros(py::list tranMatWithZeros);
-    void loadRewardsElementwise(py::list rewardsElementwise);
-    void loadTranMatElementwise(py::list tranMatElementwise);
+    void loadRewards(py::object rewards);
+    void loadTranMatWithZeros(py::object tranMatWithZeros);
+    void loadRewardsElementwise(py::object rewardsElementwise);
+    void loadTranMatElementwise(py::object tranMatElementwise);
+    void loadTranMatSparse(py::object tranMatSparse);
     void loadRewardsFromFile(string rewardsFromFile, char sep, bool header);
     void loadTranMatFromFile(string tranMatFromFile, char sep, bool header);
+    void assignRewards(const vector<int> &states, const vector<int> &actions, const vector<double> &values); //rewards from (state,action,reward) elements
+    void assignTranMat(const vector<int> &states, const vector<int> &actions, const vector<int> &nextStates, const vector<double> &probs); //transition matrix from (state,action,next state,probability) elements
     void savePolicyToFile(string fileName, char sep);
     void saveValueVectorToFile(string fileName, char sep);
 
@@ -0,0 +1,179 @@
+/*
+* MIT License
+*
+* Copyright (c) 2024 Anders Reenberg Andersen and Jesper Fink Andersen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "NumaPlacement.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <atomic>
+#include <omp.h>
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+#ifndef MPOL_MF_MOVE
+#define MPOL_MF_MOVE (1<<1) //from numaif.h, which is not always installed
+#endif
+
+static atomic<bool> threadsPinned(false); //the threads of a solve are bound to CPUs
+
+#ifdef __linux__
+static thread_local bool hasSavedCpus = false;
+static thread_local cpu_set_t savedCpus; //CPUs of the thread before pinThreads
+#endif
+
+static int readNumberOfNodes(){
+    //the online nodes are listed as ranges, e.g. "0-1" or "0,2-3"
+    int nodes = 1;
+    ifstream file("/sys/devices/system/node/online");
+    string list;
+    if (file >> list) {
+        size_t pos = list.find_last_of(",-");
+        string last = pos == string::npos ? list : list.substr(pos + 1);
+        nodes = max(1, atoi(last.c_str()) + 1);
+    }
+    return nodes;
+}
+
+int NumaPlacement::numberOfNodes(){
+    static const int nodes = readNumberOfNodes(); //initialized once, also if several threads solve at the same time
+    return nodes;
+}
+
+bool NumaPlacement::pinThreads(){
+#ifdef __linux__
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return false;
+    }
+    vector<int> cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &allowed)) {
+            cpus.push_back(cpu);
+        }
+    }
+    bool expected = false;
+    if (cpus.empty() || !threadsPinned.compare_exchange_strong(expected, true)) {
+        return false;
+    }
+    //thread t runs on the t-th CPU of the process, such that consecutive blocks
+    //of states are processed on the same node
+    #pragma omp parallel
+    {
+        hasSavedCpus = sched_getaffinity(0, sizeof(savedCpus), &savedCpus) == 0; //0 is the calling thread
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpus[omp_get_thread_num() % cpus.size()], &set);
+        sched_setaffinity(0, sizeof(set), &set);
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void NumaPlacement::unpinThreads(){
+#ifdef __linux__
+    #pragma omp parallel
+    {
+        if (hasSavedCpus) {
+            sched_setaffinity(0, sizeof(savedCpus), &savedCpus);
+            hasSavedCpus = false;
+        }
+    }
+    threadsPinned = false;
+#endif
+}
+
+vector<int> NumaPlacement::threadStates(int nStates){
+    int nThreads = omp_get_max_threads();
+    vector<int> first(nThreads + 1, nStates);
+    #pragma omp parallel
+    {
+        int thread = omp_get_thread_num();
+        #pragma omp for
+        for (int sidx = 0; sidx < nStates; sidx++) {
+            first[thread] = min(first[thread], sidx);
+        }
+    }
+    //threads without states start where the next thread starts
+    for (int t = nThreads - 1; t >= 0; t--) {
+        first[t] = min(first[t], first[t + 1]);
+    }
+    return first;
+}
+
+vector<int> NumaPlacement::threadStates(const vector<int> &chunks){
+    int nThreads = omp_get_max_threads();
+    int nChunks = chunks.size() - 1;
+    vector<int> first(nThreads + 1, chunks.back());
+    #pragma omp parallel
+    {
+        int thread = omp_get_thread_num();
+        #pragma omp for schedule(static)
+        for (int k = 0; k < nChunks; k++) {
+            first[thread] = min(first[thread], chunks[k]);
+        }
+    }
+    for (int t = nThreads - 1; t >= 0; t--) {
+        first[t] = min(first[t], first[t + 1]);
+    }
+    return first;
+}
+
+void NumaPlacement::place(const void * data, const vector<size_t> &byteOffsets){
+#ifdef __linux__
+    if (data == NULL || numberOfNodes() < 2) {
+        return;
+    }
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    size_t base = (size_t)data;
+    int nParts = byteOffsets.size() - 1;
+    #pragma omp parallel
+    {
+        int thread = omp_get_thread_num();
+        unsigned int cpu, node;
+        if (thread < nParts && syscall(SYS_getcpu, &cpu, &node, NULL) == 0) {
+            //the pages that start in the part of this thread (the first page also if it starts before)
+            size_t start = base + byteOffsets[thread];
+            size_t end = base + byteOffsets[thread + 1];
+            size_t page = thread == 0 ? start / pageSize * pageSize : (start + pageSize - 1) / pageSize * pageSize;
+            const int batchSize = 1024;
+            vector<void *> pages;
+            pages.reserve(batchSize);
+            vector<int> nodes(batchSize, (int)node), status(batchSize);
+            for (; page < end; page += pageSize) {
+                pages.push_back((void *)page);
+                if ((int)pages.size() == batchSize || page + pageSize >= end) {
+                    syscall(SYS_move_pages, 0, pages.size(), pages.data(), nodes.data(), status.data(), MPOL_MF_MOVE);
+                    pages.clear();
+                }
+            }
+        }
+    }
+#endif
+}
@@ -0,0 +1,63 @@
+/*
+* MIT License
+*
+* Copyright (c) 2024 Anders Reenberg Andersen and Jesper Fink Andersen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+#ifndef NUMAPLACEMENT_H
+#define NUMAPLACEMENT_H
+
+//Placement of the solver data on the NUMA nodes of the threads that process it. The arrays are filled
+//by a single thread while the model is loaded, so all their pages are first touched on one node. The
+//parallel loops of the solver assign the states to the threads with the static schedule of "omp for",
+//and place() moves the pages of each thread's part of an array to the node that thread runs on (Linux
+//move_pages). On other systems, and on machines with a single node, the functions do nothing.
+class NumaPlacement {
+public:
+
+    //METHODS
+    static int numberOfNodes(); //number of NUMA nodes (1 if unknown)
+    //binds each OpenMP thread (including the calling thread) to one CPU of the process until unpinThreads.
+    //returns false and does nothing if the threads of another solve are bound, since both would use the same CPUs.
+    static bool pinThreads();
+    static void unpinThreads(); //restores the CPUs that the threads could run on before pinThreads
+    static vector<int> threadStates(int nStates); //first state of each thread in a static "omp for" over the states, and nStates
+    static vector<int> threadStates(const vector<int> &chunks); //the same for a static "omp for" over chunks of states (see WorkPartition)
+    static void place(const void * data, const vector<size_t> &byteOffsets); //thread t moves the pages of bytes byteOffsets[t] to byteOffsets[t+1]-1 to its node
+    template <class T> static void place(const vector<T> &values, const vector<long long> &offsets); //the same with element offsets
+
+};
+
+template <class T>
+void NumaPlacement::place(const vector<T> &values, const vector<long long> &offsets){
+    vector<size_t> byteOffsets(offsets.size());
+    for (size_t t = 0; t < offsets.size(); t++) {
+        byteOffsets[t] = offsets[t] * sizeof(T);
+    }
+    place(values.data(), byteOffsets);
+}
+
+#endif /* NUMAPLACEMENT_H */
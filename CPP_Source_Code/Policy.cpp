@@ -45,8 +45,4 @@ void Policy::setSize(int numberOfStates){
 
 void Policy::assignPolicy(int& sidx, int& action){
     policy[sidx] = action;
-}
-
-int* Policy::getPolicy(int& sidx){
-    return &policy[sidx];
 }
\ No newline at end of file
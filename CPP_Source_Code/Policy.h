@@ -59,5 +59,10 @@ private:
     
 };
 
+//defined here so that it can be inlined into the solver kernels
+inline int* Policy::getPolicy(int& sidx){
+    return &policy[sidx];
+}
+
 #endif /* POLICY_H */
 
@@ -23,7 +23,9 @@ PYBIND11_MODULE(solvermodule, m) {
         py::arg("tranMatElementwise")=py::list(),
         py::arg("tranMatProbs")=py::list(),
         py::arg("tranMatColumns")=py::list(),
-        py::arg("tranMatFromFile")="transitions.csv")
+        py::arg("tranMatFromFile")="transitions.csv",
+        py::arg("modelFromFile")="",
+        py::arg("tranMatSparse")=py::none())
         .def("tbm", &ModuleInterface::tbm,"Selects the TBM model.", //TBM MODEL
         py::arg("discount")=0.99,
         py::arg("components")=2,
@@ -57,7 +59,16 @@ PYBIND11_MODULE(solvermodule, m) {
         py::arg("verbose")=false,
         py::arg("postProcessing")=true,
         py::arg("makeFinalCheck")=true,
-        py::arg("parallel")=true)
+        py::arg("parallel")=true,
+        py::arg("evaluation")="iterative",
+        py::arg("decompose")=false,
+        py::arg("andersonDepth")=0,
+        py::arg("adaptiveParIter")=false,
+        py::arg("adaptiveSOR")=false,
+        py::arg("pinThreads")=false,
+        py::arg("workStealing")=false,
+        py::arg("mixedPrecision")=false,
+        py::arg("actionElimination")=true)
         .def("getRuntime",&ModuleInterface::getRuntime,"Returns the runtime in milliseconds.") //OUTPUT
         .def("printPolicy", &ModuleInterface::printPolicy,"Prints the entire policy.")
         .def("printValueVector", &ModuleInterface::printValueVector,"Prints the entire value vector.")
@@ -65,6 +76,13 @@ PYBIND11_MODULE(solvermodule, m) {
         .def("getValue", &ModuleInterface::getValue,"Returns a value from the optimized policy.",py::arg("stateIndex")=0)
         .def("getPolicy", &ModuleInterface::getPolicy,"Returns the optimized policy.")
         .def("getValueVector", &ModuleInterface::getValueVector,"Returns the optimized value vector.")
-        .def("saveToFile", &ModuleInterface::saveToFile,"Saves the optimized policy or value vector to a file.",py::arg("fileName")="result.csv",py::arg("type")="policy");
+        .def("getPolicyArray", &ModuleInterface::getPolicyArray,"Returns the optimized policy as a read-only NumPy array without copying it.")
+        .def("getValueVectorArray", &ModuleInterface::getValueVectorArray,"Returns the optimized value vector as a read-only NumPy array without copying it.")
+        .def("getActions", &ModuleInterface::getActions,"Returns the action indices of several states from the optimized policy.",py::arg("stateIndices"))
+        .def("getParIterLims", &ModuleInterface::getParIterLims,"Returns the partial evaluation limits chosen by adaptive MPI.")
+        .def("getSORrelaxation", &ModuleInterface::getSORrelaxation,"Returns the SOR relaxation used at the end of the solve.")
+        .def("getTransitionRow", &ModuleInterface::getTransitionRow,"Returns the (column, probability) pairs of a row of the transition matrix.",py::arg("stateIndex")=0,py::arg("actionIndex")=0)
+        .def("saveToFile", &ModuleInterface::saveToFile,"Saves the optimized policy or value vector to a file.",py::arg("fileName")="result.csv",py::arg("type")="policy")
+        .def("saveModel", &ModuleInterface::saveModel,"Saves the general MDP model to a binary model file.",py::arg("fileName")="model.bin");
 
 }
\ No newline at end of file
@@ -0,0 +1,123 @@
+/*
+* MIT License
+*
+* Copyright (c) 2024 Anders Reenberg Andersen and Jesper Fink Andersen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "RelaxationTuner.h"
+#include <algorithm>
+#include <math.h>
+#include <limits>
+
+using namespace std;
+
+//number of reductions of the residual that estimate the contraction of Gauss-Seidel,
+//and number of sweeps without a new smallest residual before the relaxation is reduced
+static const int windowSize = 8;
+
+RelaxationTuner::RelaxationTuner():
+    relaxation(1.0),
+    estimated(false),
+    nRatios(0),
+    sweepsSinceMin(0),
+    maxRelaxation(1.9),
+    normPrev(0),
+    normMin(0),
+    logRatioSum(0)
+{
+}
+
+RelaxationTuner::RelaxationTuner(const RelaxationTuner& orig):
+    relaxation(orig.relaxation),
+    estimated(orig.estimated),
+    nRatios(orig.nRatios),
+    sweepsSinceMin(orig.sweepsSinceMin),
+    maxRelaxation(orig.maxRelaxation),
+    normPrev(orig.normPrev),
+    normMin(orig.normMin),
+    logRatioSum(orig.logRatioSum)
+{
+}
+
+RelaxationTuner::~RelaxationTuner() {
+}
+
+void RelaxationTuner::initialize(double maxRelax){
+    maxRelaxation = max(maxRelax, 1.0);
+    relaxation = 1.0;
+    estimated = false;
+    nRatios = -1; //the first reduction depends on the initial values
+    logRatioSum = 0;
+    restart();
+}
+
+void RelaxationTuner::initializeFixed(double relax){
+    maxRelaxation = relax;
+    relaxation = relax;
+    estimated = true;
+    restart();
+}
+
+void RelaxationTuner::restart(){
+    normPrev = 0;
+    normMin = numeric_limits<double>::infinity();
+    sweepsSinceMin = 0;
+}
+
+double RelaxationTuner::sweep(double norm){
+    //the change of the values in a sweep is proportional to the relaxation, so the
+    //residual of the Gauss-Seidel map is used instead
+    double residual = norm / relaxation;
+    double prev = normPrev;
+    normPrev = residual;
+
+    if (!estimated) {
+        if (prev > 0 && residual > 0 && nRatios++ >= 0) {
+            logRatioSum += log(min(residual / prev, 1.0));
+        }
+        if (nRatios == windowSize) {
+            double rho = min(exp(logRatioSum / nRatios), 1 - 1e-12);
+            double optimal = 2 / (1 + sqrt(1 - rho));
+            relaxation = min(maxRelaxation, 1 + 0.5 * (optimal - 1));
+            estimated = true;
+            restart();
+        }
+        return relaxation;
+    }
+
+    //safeguard against divergence and against cycles, where SOR does not converge
+    //although the residual does not grow
+    if (residual < normMin) {
+        normMin = residual;
+        sweepsSinceMin = 0;
+    } else {
+        sweepsSinceMin++;
+    }
+    if (relaxation > 1 && (residual > 2 * normMin || sweepsSinceMin >= windowSize)) {
+        relaxation = 1 + 0.5 * (relaxation - 1);
+        if (relaxation < 1.01) {
+            relaxation = 1.0;
+        }
+        normMin = numeric_limits<double>::infinity();
+        sweepsSinceMin = 0;
+    }
+    return relaxation;
+}
@@ -0,0 +1,62 @@
+/*
+* MIT License
+*
+* Copyright (c) 2024 Anders Reenberg Andersen and Jesper Fink Andersen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#ifndef RELAXATIONTUNER_H
+#define RELAXATIONTUNER_H
+
+//Online choice of the SOR relaxation parameter from the residuals of the sweeps. The first sweeps are
+//Gauss-Seidel sweeps (relaxation 1), and the geometric mean rho of the reductions of their residuals
+//estimates the contraction of Gauss-Seidel. For a consistently ordered Jacobi iteration matrix,
+//2/(1+sqrt(1-rho)) would be the optimal relaxation. MDPs are not consistently ordered, and the max over
+//the actions makes SOR diverge well below this value, so only half of the extrapolation is used:
+//relaxation = 1 + (2/(1+sqrt(1-rho)) - 1)/2, limited to maxRelaxation. If the residual of a later sweep
+//grows to twice the smallest residual since the relaxation was set, or does not reach a new smallest
+//residual in 8 sweeps, the relaxation is moved halfway back towards 1.
+class RelaxationTuner {
+public:
+
+    RelaxationTuner();
+    RelaxationTuner(const RelaxationTuner& orig);
+    virtual ~RelaxationTuner();
+
+    //VARIABLES
+    double relaxation; //relaxation of the next sweep
+
+    //METHODS
+    void initialize(double maxRelaxation);
+    void initializeFixed(double relaxation); //a given relaxation that is only reduced by the safeguard
+    void restart(); //the next residual is not comparable to the last one (e.g. after a policy change)
+    double sweep(double norm); //after each sweep with the current relaxation. Returns the relaxation of the next sweep.
+
+private:
+
+    //VARIABLES
+    bool estimated; //the Gauss-Seidel sweeps are done
+    int nRatios;
+    int sweepsSinceMin; //sweeps since the smallest residual
+    double maxRelaxation, normPrev, normMin, logRatioSum;
+
+};
+
+#endif /* RELAXATIONTUNER_H */
@@ -24,7 +24,10 @@
 
 #include "Rewards.h"
 
-Rewards::Rewards() {
+Rewards::Rewards():
+    external(false)
+{
+    updateView();
 }
 
 Rewards::Rewards(const Rewards& orig) {
@@ -33,33 +36,60 @@ Rewards::Rewards(const Rewards& orig) {
 Rewards::~Rewards() {
 }
 
-double Rewards::getReward(int& sidx, int& aidx){
-    return rewards[sidx][aidx];
-}
-
 void Rewards::assignReward(double reward, int& sidx, int& aidx){
     //assign single probability
-    rewards[sidx][aidx]=reward;
+    rewards[actionOffsets[sidx]+aidx]=reward;
 } 
 
 void Rewards::assignRewardsFromList(py::list pyRewards){
     //cast rewards directly from Python list
-    rewards=pyRewards.cast<vector<vector<double>>>();
+    vector<vector<double>> rows=pyRewards.cast<vector<vector<double>>>();
+    external=false;
+    actionOffsets.assign(rows.size()+1,0);
+    rewards.clear();
+    for (size_t sidx=0; sidx<rows.size(); sidx++){
+        actionOffsets[sidx+1]=actionOffsets[sidx]+rows[sidx].size();
+        rewards.insert(rewards.end(),rows[sidx].begin(),rows[sidx].end());
+    }
+    updateView();
 } 
     
+void Rewards::assignExternalRewards(const double * stateRewards, int numberOfStates, int nActions){
+    setNumberOfRows(numberOfStates);
+    for (int sidx=0; sidx<numberOfStates; sidx++){
+        actionOffsets[sidx+1]=actionOffsets[sidx]+nActions;
+    }
+    updateView();
+    rewardsView=stateRewards;
+    external=true;
+}
+
 void Rewards::setNumberOfRows(int numberOfStates){
-    rewards.resize(numberOfStates);
+    external=false;
+    actionOffsets.assign(numberOfStates+1,0);
+    rewards.clear();
+    updateView();
 }
 
 void Rewards::setNumberOfActions(int nActions, int& sidx){
-    rewards[sidx].resize(nActions,-1);
+    actionOffsets[sidx+1]=actionOffsets[sidx]+nActions;
+    rewards.resize(actionOffsets[sidx+1],-1);
+    updateView();
 }
     
 int Rewards::numberOfActions(int& sidx){
-    return rewards[sidx].size();
+    return actionOffsetsView[sidx+1]-actionOffsetsView[sidx];
 }
 
 int Rewards::numberOfRows(){
-    return rewards.size();
+    return nStates;
 }
 
+void Rewards::updateView(){
+    if (external){
+        return;
+    }
+    rewardsView=rewards.data();
+    actionOffsetsView=actionOffsets.data();
+    nStates=actionOffsets.empty() ? 0 : actionOffsets.size()-1;
+}
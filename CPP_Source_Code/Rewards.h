@@ -45,8 +45,12 @@ public:
     double getReward(int& sidx, int& aidx);
     void assignReward(double reward, int& sidx, int& aidx); //assign single probability
     void assignRewardsFromList(py::list pyRewards); //cast probabilities directly from Python list
+    //rewards of nActions actions in each state, stored state by state in an array of the caller (e.g. a NumPy array),
+    //which is used without copying and must be kept alive until the rewards are reassigned
+    void assignExternalRewards(const double * stateRewards, int numberOfStates, int nActions);
     
     //set size of array
+    //NB! states must be sized in increasing order, since each call appends to the contiguous array of rewards.
     void setNumberOfRows(int numberOfStates);
     void setNumberOfActions(int nActions, int& sidx);
     
@@ -56,9 +60,29 @@ public:
 private:
 
     //VARIABLES
-    vector<vector<double>> rewards; //array of rewards (index1: state, index2: action)
+    //rewards of all (state,action) pairs, stored state by state. The reward of state sidx and
+    //action aidx is rewards[actionOffsets[sidx]+aidx].
+    vector<double> rewards;
+    vector<int> actionOffsets;
+    
+    //the arrays are read through these pointers, which point into the vectors above, into the pages of
+    //a mapped model file (see ModelFile), or into an array given by the caller (see assignExternalRewards)
+    const double * rewardsView;
+    const int * actionOffsetsView;
+    int nStates;
+    bool external; //rewardsView or both pointers are not owned
+    
+    //METHODS
+    void updateView();
+    
+    friend class ModelFile;
     
 };
 
+//defined here so that it can be inlined into the solver kernels
+inline double Rewards::getReward(int& sidx, int& aidx){
+    return rewardsView[actionOffsetsView[sidx]+aidx];
+}
+
 #endif /* REWARDS_H */
 
@@ -0,0 +1,441 @@
+/*
+* MIT License
+*
+* Copyright (c) 2024 Anders Reenberg Andersen and Jesper Fink Andersen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "RowKernel.h"
+#include <cstdlib>
+#include <cstring>
+
+//The SIMD kernels are only compiled for x86. GCC and Clang compile each kernel for its own
+//target through a function attribute, such that the rest of the module stays generic.
+//MSVC allows the intrinsics without any special flags.
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define ROWKERNEL_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define TARGET_AVX2
+#define TARGET_AVX512
+#else
+#define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+#endif
+
+using namespace std;
+
+enum InstructionSet { SCALAR = 0, SSE2 = 1, AVX2 = 2, AVX512 = 3 };
+
+
+//ROW FORMATS
+//the probabilities are double (probs) or float (probsSingle), and the columns are full indices (cols)
+//or 16-bit deltas from colBase (colDeltas). Each kernel is instantiated for the four combinations.
+
+template <class Prob> static inline const Prob * rowProbs(const TransitionRow &row);
+template <> inline const double * rowProbs<double>(const TransitionRow &row){ return row.probs; }
+template <> inline const float * rowProbs<float>(const TransitionRow &row){ return row.probsSingle; }
+
+template <class Col> static inline const Col * rowCols(const TransitionRow &row);
+template <> inline const int * rowCols<int>(const TransitionRow &row){ return row.cols; }
+template <> inline const unsigned short * rowCols<unsigned short>(const TransitionRow &row){ return row.colDeltas; }
+
+
+//SCALAR
+
+template <class Prob, class Col>
+static double dotScalar(const TransitionRow &row, const double * v){
+    const Prob * probs = rowProbs<Prob>(row);
+    const Col * cols = rowCols<Col>(row);
+    v += row.colBase;
+    double valSum = 0;
+    for (int cidx = 0; cidx < row.length; cidx++){
+        valSum += (double)probs[cidx] * v[cols[cidx]];
+    }
+    return valSum;
+}
+
+template <class Prob, class Col>
+static void dotPairScalar(const TransitionRow &rowA, const TransitionRow &rowB, const double * v, double * out){
+    out[0] = dotScalar<Prob, Col>(rowA, v);
+    out[1] = dotScalar<Prob, Col>(rowB, v);
+}
+
+#ifdef ROWKERNEL_X86
+
+//SSE2
+//no gather instruction, but two independent accumulators hide the latency of the additions.
+
+static inline __m128d loadProbsSSE2(const double * probs){
+    return _mm_loadu_pd(probs);
+}
+
+static inline __m128d loadProbsSSE2(const float * probs){
+    return _mm_cvtps_pd(_mm_castpd_ps(_mm_load_sd((const double *)probs)));
+}
+
+static inline double horizontalSumSSE2(__m128d acc){
+    return _mm_cvtsd_f64(_mm_add_sd(acc, _mm_unpackhi_pd(acc, acc)));
+}
+
+template <class Prob, class Col>
+static double dotSSE2(const TransitionRow &row, const double * v){
+    const Prob * probs = rowProbs<Prob>(row);
+    const Col * cols = rowCols<Col>(row);
+    v += row.colBase;
+    __m128d acc = _mm_setzero_pd();
+    int cidx = 0;
+    for (; cidx + 2 <= row.length; cidx += 2){
+        __m128d vals = _mm_set_pd(v[cols[cidx + 1]], v[cols[cidx]]);
+        acc = _mm_add_pd(acc, _mm_mul_pd(loadProbsSSE2(probs + cidx), vals));
+    }
+    if (cidx < row.length){
+        acc = _mm_add_sd(acc, _mm_set_sd((double)probs[cidx] * v[cols[cidx]]));
+    }
+    return horizontalSumSSE2(acc);
+}
+
+template <class Prob, class Col>
+static void dotPairSSE2(const TransitionRow &rowA, const TransitionRow &rowB, const double * v, double * out){
+    out[0] = dotSSE2<Prob, Col>(rowA, v);
+    out[1] = dotSSE2<Prob, Col>(rowB, v);
+}
+
+//AVX2
+//four values are gathered at a time. The last (length % 4) elements are handled with a
+//masked gather, so rows of any length are processed without a scalar remainder loop.
+
+TARGET_AVX2 static inline __m256d loadProbsAVX2(const double * probs){
+    return _mm256_loadu_pd(probs);
+}
+
+TARGET_AVX2 static inline __m256d loadProbsAVX2(const float * probs){
+    return _mm256_cvtps_pd(_mm_loadu_ps(probs));
+}
+
+TARGET_AVX2 static inline __m256d maskLoadProbsAVX2(const double * probs, __m128i mask32){
+    return _mm256_maskload_pd(probs, _mm256_cvtepi32_epi64(mask32));
+}
+
+TARGET_AVX2 static inline __m256d maskLoadProbsAVX2(const float * probs, __m128i mask32){
+    return _mm256_cvtps_pd(_mm_maskload_ps(probs, mask32));
+}
+
+TARGET_AVX2 static inline __m128i loadColsAVX2(const int * cols){
+    return _mm_loadu_si128((const __m128i *)cols);
+}
+
+TARGET_AVX2 static inline __m128i loadColsAVX2(const unsigned short * cols){
+    return _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *)cols));
+}
+
+TARGET_AVX2 static inline __m128i maskLoadColsAVX2(const int * cols, int, __m128i mask32){
+    return _mm_maskload_epi32(cols, mask32);
+}
+
+TARGET_AVX2 static inline __m128i maskLoadColsAVX2(const unsigned short * cols, int remaining, __m128i){
+    //there are no masked 16-bit loads
+    return _mm_setr_epi32(cols[0], remaining > 1 ? cols[1] : 0, remaining > 2 ? cols[2] : 0, 0);
+}
+
+template <class Prob, class Col>
+TARGET_AVX2 static inline __m256d accumulateAVX2(const Prob * probs, const Col * cols, int length, const double * v, __m256d acc){
+    int cidx = 0;
+    for (; cidx + 4 <= length; cidx += 4){
+        __m256d vals = _mm256_i32gather_pd(v, loadColsAVX2(cols + cidx), 8);
+        acc = _mm256_fmadd_pd(loadProbsAVX2(probs + cidx), vals, acc);
+    }
+    if (cidx < length){
+        //remaining is between 1 and 3
+        int remaining = length - cidx;
+        __m128i mask32 = _mm_cmpgt_epi32(_mm_set1_epi32(remaining), _mm_setr_epi32(0, 1, 2, 3));
+        __m256i mask64 = _mm256_cvtepi32_epi64(mask32);
+        __m128i idx = maskLoadColsAVX2(cols + cidx, remaining, mask32);
+        __m256d vals = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), v, idx, _mm256_castsi256_pd(mask64), 8);
+        acc = _mm256_fmadd_pd(maskLoadProbsAVX2(probs + cidx, mask32), vals, acc);
+    }
+    return acc;
+}
+
+TARGET_AVX2 static inline double horizontalSumAVX2(__m256d acc){
+    __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+}
+
+template <class Prob, class Col>
+TARGET_AVX2 static double dotAVX2(const TransitionRow &row, const double * v){
+    return horizontalSumAVX2(accumulateAVX2(rowProbs<Prob>(row), rowCols<Col>(row), row.length, v + row.colBase, _mm256_setzero_pd()));
+}
+
+template <class Prob, class Col>
+TARGET_AVX2 static void dotPairAVX2(const TransitionRow &rowA, const TransitionRow &rowB, const double * v, double * out){
+    //the gathers of the two rows are independent, so interleaving them keeps more loads in flight
+    const Prob * probsA = rowProbs<Prob>(rowA);
+    const Prob * probsB = rowProbs<Prob>(rowB);
+    const Col * colsA = rowCols<Col>(rowA);
+    const Col * colsB = rowCols<Col>(rowB);
+    const double * vA = v + rowA.colBase;
+    const double * vB = v + rowB.colBase;
+    __m256d accA = _mm256_setzero_pd();
+    __m256d accB = _mm256_setzero_pd();
+    int common = (rowA.length < rowB.length ? rowA.length : rowB.length) & ~3;
+    for (int cidx = 0; cidx < common; cidx += 4){
+        __m256d valsA = _mm256_i32gather_pd(vA, loadColsAVX2(colsA + cidx), 8);
+        __m256d valsB = _mm256_i32gather_pd(vB, loadColsAVX2(colsB + cidx), 8);
+        accA = _mm256_fmadd_pd(loadProbsAVX2(probsA + cidx), valsA, accA);
+        accB = _mm256_fmadd_pd(loadProbsAVX2(probsB + cidx), valsB, accB);
+    }
+    accA = accumulateAVX2(probsA + common, colsA + common, rowA.length - common, vA, accA);
+    accB = accumulateAVX2(probsB + common, colsB + common, rowB.length - common, vB, accB);
+    out[0] = horizontalSumAVX2(accA);
+    out[1] = horizontalSumAVX2(accB);
+}
+
+//AVX-512
+//eight values are gathered at a time and the tail uses a mask register. Only AVX-512F
+//instructions are used.
+
+TARGET_AVX512 static inline __m512d loadProbsAVX512(const double * probs){
+    return _mm512_loadu_pd(probs);
+}
+
+TARGET_AVX512 static inline __m512d loadProbsAVX512(const float * probs){
+    return _mm512_cvtps_pd(_mm256_loadu_ps(probs));
+}
+
+TARGET_AVX512 static inline __m512d maskLoadProbsAVX512(const double * probs, __mmask8 mask){
+    return _mm512_maskz_loadu_pd(mask, probs);
+}
+
+TARGET_AVX512 static inline __m512d maskLoadProbsAVX512(const float * probs, __mmask8 mask){
+    return _mm512_cvtps_pd(_mm512_castps512_ps256(_mm512_maskz_loadu_ps((__mmask16)mask, probs)));
+}
+
+TARGET_AVX512 static inline __m256i loadColsAVX512(const int * cols){
+    return _mm256_loadu_si256((const __m256i *)cols);
+}
+
+TARGET_AVX512 static inline __m256i loadColsAVX512(const unsigned short * cols){
+    return _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)cols));
+}
+
+TARGET_AVX512 static inline __m256i maskLoadColsAVX512(const int * cols, int, __mmask8 mask){
+    return _mm512_castsi512_si256(_mm512_maskz_loadu_epi32((__mmask16)mask, cols));
+}
+
+TARGET_AVX512 static inline __m256i maskLoadColsAVX512(const unsigned short * cols, int remaining, __mmask8){
+    //masked 16-bit loads require AVX-512BW
+    int idx[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    for (int k = 0; k < remaining; k++){
+        idx[k] = cols[k];
+    }
+    return _mm256_loadu_si256((const __m256i *)idx);
+}
+
+template <class Prob, class Col>
+TARGET_AVX512 static inline __m512d accumulateAVX512(const Prob * probs, const Col * cols, int length, const double * v, __m512d acc){
+    int cidx = 0;
+    for (; cidx + 8 <= length; cidx += 8){
+        __m512d vals = _mm512_i32gather_pd(loadColsAVX512(cols + cidx), v, 8);
+        acc = _mm512_fmadd_pd(loadProbsAVX512(probs + cidx), vals, acc);
+    }
+    if (cidx < length){
+        int remaining = length - cidx;
+        __mmask8 mask = (__mmask8)((1u << remaining) - 1);
+        __m256i idx = maskLoadColsAVX512(cols + cidx, remaining, mask);
+        __m512d vals = _mm512_mask_i32gather_pd(_mm512_setzero_pd(), mask, idx, v, 8);
+        acc = _mm512_fmadd_pd(maskLoadProbsAVX512(probs + cidx, mask), vals, acc);
+    }
+    return acc;
+}
+
+template <class Prob, class Col>
+TARGET_AVX512 static double dotAVX512(const TransitionRow &row, const double * v){
+    return _mm512_reduce_add_pd(accumulateAVX512(rowProbs<Prob>(row), rowCols<Col>(row), row.length, v + row.colBase, _mm512_setzero_pd()));
+}
+
+template <class Prob, class Col>
+TARGET_AVX512 static void dotPairAVX512(const TransitionRow &rowA, const TransitionRow &rowB, const double * v, double * out){
+    const Prob * probsA = rowProbs<Prob>(rowA);
+    const Prob * probsB = rowProbs<Prob>(rowB);
+    const Col * colsA = rowCols<Col>(rowA);
+    const Col * colsB = rowCols<Col>(rowB);
+    const double * vA = v + rowA.colBase;
+    const double * vB = v + rowB.colBase;
+    __m512d accA = _mm512_setzero_pd();
+    __m512d accB = _mm512_setzero_pd();
+    int common = (rowA.length < rowB.length ? rowA.length : rowB.length) & ~7;
+    for (int cidx = 0; cidx < common; cidx += 8){
+        __m512d valsA = _mm512_i32gather_pd(loadColsAVX512(colsA + cidx), vA, 8);
+        __m512d valsB = _mm512_i32gather_pd(loadColsAVX512(colsB + cidx), vB, 8);
+        accA = _mm512_fmadd_pd(loadProbsAVX512(probsA + cidx), valsA, accA);
+        accB = _mm512_fmadd_pd(loadProbsAVX512(probsB + cidx), valsB, accB);
+    }
+    accA = accumulateAVX512(probsA + common, colsA + common, rowA.length - common, vA, accA);
+    accB = accumulateAVX512(probsB + common, colsB + common, rowB.length - common, vB, accB);
+    out[0] = _mm512_reduce_add_pd(accA);
+    out[1] = _mm512_reduce_add_pd(accB);
+}
+
+//CPU FEATURES
+
+static int supportedInstructionSet(){
+    //highest instruction set supported by both the CPU and the operating system
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+    __cpuid(info, 1);
+    bool sse2 = (info[3] & (1 << 26)) != 0;
+    bool fma = (info[2] & (1 << 12)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    bool avx2 = false, avx512f = false;
+    if (maxLeaf >= 7){
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+        avx512f = (info[1] & (1 << 16)) != 0;
+    }
+    unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+    bool osAVX = (xcr0 & 0x6) == 0x6; //XMM and YMM state
+    bool osAVX512 = (xcr0 & 0xE6) == 0xE6; //XMM, YMM, opmask and ZMM state
+    if (avx512f && osAVX512){
+        return AVX512;
+    }
+    if (avx && avx2 && fma && osAVX){
+        return AVX2;
+    }
+    return sse2 ? SSE2 : SCALAR;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")){
+        return AVX512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")){
+        return AVX2;
+    }
+    return __builtin_cpu_supports("sse2") ? SSE2 : SCALAR;
+#endif
+}
+
+#else
+
+static int supportedInstructionSet(){
+    return SCALAR;
+}
+
+#endif
+
+
+//instances of a kernel for the row formats in the order of RowKernel::rowFormat
+#define SELECT_KERNELS(dot, dotPair) \
+    dotFunctions[0] = dot<double, int>; \
+    dotFunctions[1] = dot<float, int>; \
+    dotFunctions[2] = dot<double, unsigned short>; \
+    dotFunctions[3] = dot<float, unsigned short>; \
+    dotPairFunctions[0] = dotPair<double, int>; \
+    dotPairFunctions[1] = dotPair<float, int>; \
+    dotPairFunctions[2] = dotPair<double, unsigned short>; \
+    dotPairFunctions[3] = dotPair<float, unsigned short>
+
+
+RowKernel::RowKernel() {
+    selectInstructionSet();
+}
+
+RowKernel::RowKernel(const RowKernel& orig):
+    instructionSet(orig.instructionSet)
+{
+    for (int format = 0; format < 4; format++){
+        dotFunctions[format] = orig.dotFunctions[format];
+        dotPairFunctions[format] = orig.dotPairFunctions[format];
+    }
+}
+
+RowKernel::~RowKernel() {
+}
+
+void RowKernel::selectInstructionSet(){
+    instructionSet = supportedInstructionSet();
+
+    //optional override, e.g. to compare results with the scalar kernel.
+    //an instruction set that is not supported by the CPU is never selected.
+    const char * requested = getenv("MDPSOLVER_SIMD");
+    if (requested != NULL){
+        int level = instructionSet;
+        if (strcmp(requested, "scalar") == 0){
+            level = SCALAR;
+        }else if (strcmp(requested, "sse2") == 0){
+            level = SSE2;
+        }else if (strcmp(requested, "avx2") == 0){
+            level = AVX2;
+        }else if (strcmp(requested, "avx512") == 0){
+            level = AVX512;
+        }
+        if (level < instructionSet){
+            instructionSet = level;
+        }
+    }
+
+    switch (instructionSet){
+#ifdef ROWKERNEL_X86
+        case AVX512:
+            SELECT_KERNELS(dotAVX512, dotPairAVX512);
+            break;
+        case AVX2:
+            SELECT_KERNELS(dotAVX2, dotPairAVX2);
+            break;
+        case SSE2:
+            SELECT_KERNELS(dotSSE2, dotPairSSE2);
+            break;
+#endif
+        default:
+            SELECT_KERNELS(dotScalar, dotPairScalar);
+            break;
+    }
+}
+
+void RowKernel::dot(const TransitionRow * rows, int nRows, const double * v, double * out) const {
+    //the rows are processed in pairs of the same format
+    int ridx = 0;
+    for (; ridx + 2 <= nRows; ridx += 2){
+        int format = rowFormat(rows[ridx]);
+        if (format == rowFormat(rows[ridx + 1])){
+            dotPairFunctions[format](rows[ridx], rows[ridx + 1], v, out + ridx);
+        }else{
+            out[ridx] = dotFunctions[format](rows[ridx], v);
+            out[ridx + 1] = dot(rows[ridx + 1], v);
+        }
+    }
+    if (ridx < nRows){
+        out[ridx] = dot(rows[ridx], v);
+    }
+}
+
+string RowKernel::getInstructionSet() const {
+    switch (instructionSet){
+        case AVX512: return "avx512";
+        case AVX2: return "avx2";
+        case SSE2: return "sse2";
+        default: return "scalar";
+    }
+}
@@ -0,0 +1,74 @@
+/*
+* MIT License
+*
+* Copyright (c) 2024 Anders Reenberg Andersen and Jesper Fink Andersen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "ModelType.h"
+#include <string>
+
+using namespace std;
+
+#ifndef ROWKERNEL_H
+#define ROWKERNEL_H
+
+//Computes the row products sum_c probs[c]*v[cols[c]] used in the Bellman updates.
+//The instruction set (scalar, SSE2, AVX2 or AVX-512) is selected at runtime from the
+//features of the CPU, such that a generic build of the module still uses gather
+//instructions where they are available. The selection can be overridden with the
+//environment variable MDPSOLVER_SIMD (scalar, sse2, avx2 or avx512).
+//Rows with single-precision probabilities (probsSingle) are converted to double
+//precision in registers, so the products are always accumulated in double precision.
+//Compressed column indices (colDeltas) are widened and added to colBase in registers.
+class RowKernel {
+public:
+
+    RowKernel();
+    RowKernel(const RowKernel& orig);
+    virtual ~RowKernel();
+
+    //METHODS
+    double dot(const TransitionRow &row, const double * v) const; //product of a single row and v
+    void dot(const TransitionRow * rows, int nRows, const double * v, double * out) const; //products of several rows (e.g. all actions of a state) and v
+    string getInstructionSet() const;
+
+private:
+
+    //VARIABLES
+    int instructionSet;
+    double (*dotFunctions[4])(const TransitionRow &row, const double * v); //one kernel per row format
+    void (*dotPairFunctions[4])(const TransitionRow &rowA, const TransitionRow &rowB, const double * v, double * out);
+
+    //METHODS
+    void selectInstructionSet();
+    static int rowFormat(const TransitionRow &row); //0: double/int, 1: float/int, 2: double/16-bit, 3: float/16-bit
+
+};
+
+inline int RowKernel::rowFormat(const TransitionRow &row) {
+    return (row.probsSingle != NULL ? 1 : 0) + (row.colDeltas != NULL ? 2 : 0);
+}
+
+inline double RowKernel::dot(const TransitionRow &row, const double * v) const {
+    return dotFunctions[rowFormat(row)](row, v);
+}
+
+#endif /* ROWKERNEL_H */
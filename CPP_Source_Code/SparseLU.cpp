@@ -0,0 +1,313 @@
+/*
+* MIT License
+*
+* Copyright (c) 2024 Anders Reenberg Andersen and Jesper Fink Andersen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "SparseLU.h"
+#include <algorithm>
+
+SparseLU::SparseLU():
+    n(0)
+{
+}
+
+SparseLU::SparseLU(const SparseLU& orig):
+    n(orig.n),
+    perm(orig.perm),
+    Lp(orig.Lp), Up(orig.Up),
+    Li(orig.Li), Ui(orig.Ui),
+    Lx(orig.Lx), Ux(orig.Ux),
+    Udiag(orig.Udiag)
+{
+}
+
+SparseLU::~SparseLU() {
+}
+
+void SparseLU::clear(){
+    n = 0;
+    vector<int>().swap(perm);
+    vector<long long>().swap(Lp); vector<long long>().swap(Up);
+    vector<int>().swap(Li); vector<int>().swap(Ui);
+    vector<double>().swap(Lx); vector<double>().swap(Ux);
+    vector<double>().swap(Udiag);
+}
+
+bool SparseLU::empty() const {
+    return Udiag.empty();
+}
+
+long long SparseLU::numberOfNonZeros() const {
+    return (long long)Li.size() + (long long)Ui.size() + n;
+}
+
+bool SparseLU::factorize(int size, const vector<long long> &rowOffsets, const vector<int> &cols, const vector<double> &vals, long long maxNonZeros){
+    n = size;
+
+    //symmetrized pattern of A without the diagonal
+    vector<long long> adjOffsets(n + 1, 0);
+    for (int i = 0; i < n; i++) {
+        for (long long p = rowOffsets[i]; p < rowOffsets[i + 1]; p++) {
+            if (cols[p] != i) {
+                adjOffsets[i + 1]++;
+                adjOffsets[cols[p] + 1]++;
+            }
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        adjOffsets[i + 1] += adjOffsets[i];
+    }
+    vector<int> adj(adjOffsets[n]);
+    vector<long long> pos(adjOffsets.begin(), adjOffsets.end() - 1);
+    for (int i = 0; i < n; i++) {
+        for (long long p = rowOffsets[i]; p < rowOffsets[i + 1]; p++) {
+            if (cols[p] != i) {
+                adj[pos[i]++] = cols[p];
+                adj[pos[cols[p]]++] = i;
+            }
+        }
+    }
+    reverseCuthillMcKee(adjOffsets, adj);
+    vector<int> inv(n);
+    for (int k = 0; k < n; k++) {
+        inv[perm[k]] = k;
+    }
+
+    //B = P*A*P' in CSC format
+    vector<long long> Bp(n + 1, 0);
+    for (long long p = 0; p < rowOffsets[n]; p++) {
+        Bp[inv[cols[p]] + 1]++;
+    }
+    for (int j = 0; j < n; j++) {
+        Bp[j + 1] += Bp[j];
+    }
+    vector<int> Bi(rowOffsets[n]);
+    vector<double> Bx(rowOffsets[n]);
+    pos.assign(Bp.begin(), Bp.end() - 1);
+    for (int i = 0; i < n; i++) {
+        for (long long p = rowOffsets[i]; p < rowOffsets[i + 1]; p++) {
+            long long q = pos[inv[cols[p]]]++;
+            Bi[q] = inv[i];
+            Bx[q] = vals[p];
+        }
+    }
+
+    //left-looking LU: column j of L and U is found by solving L*x = B(:,j), where the
+    //non-zero pattern of x is the set of nodes reachable from B(:,j) in the graph of L
+    Lp.assign(n + 1, 0);
+    Up.assign(n + 1, 0);
+    Li.clear(); Lx.clear(); Ui.clear(); Ux.clear();
+    Udiag.assign(n, 0.0);
+    vector<double> x(n, 0.0); //dense work vector
+    vector<int> visited(n, -1); //column in which a node was last visited
+    vector<int> reach(n); //reach[top..n-1] holds the pattern of x in topological order
+    vector<int> stack(n);
+    vector<long long> childPos(n);
+    long long work = 0; //multiply-adds of the numerical solves
+    for (int j = 0; j < n; j++) {
+        //depth-first search from each non-zero of B(:,j)
+        int top = n;
+        for (long long p = Bp[j]; p < Bp[j + 1]; p++) {
+            int start = Bi[p];
+            if (visited[start] == j) {
+                continue;
+            }
+            int head = 0;
+            stack[0] = start;
+            while (head >= 0) {
+                int node = stack[head];
+                if (visited[node] != j) {
+                    visited[node] = j;
+                    childPos[head] = node < j ? Lp[node] : 0; //columns >= j have no edges yet
+                }
+                long long end = node < j ? Lp[node + 1] : 0;
+                bool done = true;
+                for (long long q = childPos[head]; q < end; q++) {
+                    int child = Li[q];
+                    if (visited[child] != j) {
+                        childPos[head] = q + 1;
+                        stack[++head] = child;
+                        done = false;
+                        break;
+                    }
+                }
+                if (done) {
+                    head--;
+                    reach[--top] = node;
+                }
+            }
+        }
+
+        //numerical solve
+        for (long long p = Bp[j]; p < Bp[j + 1]; p++) {
+            x[Bi[p]] += Bx[p];
+        }
+        for (int k = top; k < n; k++) {
+            int node = reach[k];
+            if (node < j) {
+                double xNode = x[node];
+                work += Lp[node + 1] - Lp[node];
+                for (long long q = Lp[node]; q < Lp[node + 1]; q++) {
+                    x[Li[q]] -= Lx[q] * xNode;
+                }
+            }
+        }
+
+        //store U(:,j) and L(:,j), and clear the work vector
+        double pivot = x[j];
+        Udiag[j] = pivot;
+        for (int k = top; k < n; k++) {
+            int node = reach[k];
+            if (node < j) {
+                Ui.push_back(node);
+                Ux.push_back(x[node]);
+            } else if (node > j) {
+                Li.push_back(node);
+                Lx.push_back(x[node] / pivot);
+            }
+            x[node] = 0;
+        }
+        Up[j + 1] = Ui.size();
+        Lp[j + 1] = Li.size();
+        if ((long long)(Li.size() + Ui.size()) > maxNonZeros || work > 100 * maxNonZeros) {
+            clear(); //too much fill-in, release the partial factors
+            return false;
+        }
+    }
+    return true;
+}
+
+void SparseLU::solve(vector<double> &b) const {
+    vector<double> y(n);
+    for (int k = 0; k < n; k++) {
+        y[k] = b[perm[k]];
+    }
+    //L*z = y
+    for (int j = 0; j < n; j++) {
+        double yj = y[j];
+        if (yj != 0) {
+            for (long long q = Lp[j]; q < Lp[j + 1]; q++) {
+                y[Li[q]] -= Lx[q] * yj;
+            }
+        }
+    }
+    //U*x = z
+    for (int j = n - 1; j >= 0; j--) {
+        y[j] /= Udiag[j];
+        double yj = y[j];
+        if (yj != 0) {
+            for (long long q = Up[j]; q < Up[j + 1]; q++) {
+                y[Ui[q]] -= Ux[q] * yj;
+            }
+        }
+    }
+    for (int k = 0; k < n; k++) {
+        b[perm[k]] = y[k];
+    }
+}
+
+void SparseLU::reverseCuthillMcKee(const vector<long long> &adjOffsets, const vector<int> &adj){
+    //Cuthill-McKee ordering of each connected component, started from a pseudo-peripheral
+    //node, and reversed at the end.
+    perm.clear();
+    perm.reserve(n);
+    vector<int> level(n, -1);
+    vector<int> degree(n);
+    for (int i = 0; i < n; i++) {
+        degree[i] = adjOffsets[i + 1] - adjOffsets[i];
+    }
+    vector<int> order(n); //nodes sorted by degree, used to pick the start of each component
+    for (int i = 0; i < n; i++) {
+        order[i] = i;
+    }
+    stable_sort(order.begin(), order.end(), [&](int a, int b){ return degree[a] < degree[b]; });
+    vector<int> queue(n);
+    vector<int> mark(n, -1); //stamp of the last search that reached a node
+    int stamp = -1;
+    vector<int> neighbours;
+
+    for (int o = 0; o < n; o++) {
+        int root = order[o];
+        if (level[root] >= 0) {
+            continue;
+        }
+
+        //pseudo-peripheral node: repeat breadth-first searches from a node of minimum
+        //degree in the last level as long as the number of levels grows
+        int nLevels = 0;
+        for (int attempt = 0; attempt < 5; attempt++) {
+            int head = 0, tail = 0;
+            queue[tail++] = root;
+            mark[root] = ++stamp;
+            int lastLevelStart = 0, depth = 0;
+            int currentLevelEnd = tail;
+            while (head < tail) {
+                if (head == currentLevelEnd) {
+                    depth++;
+                    lastLevelStart = head;
+                    currentLevelEnd = tail;
+                }
+                int node = queue[head++];
+                for (long long p = adjOffsets[node]; p < adjOffsets[node + 1]; p++) {
+                    int nb = adj[p];
+                    if (mark[nb] != stamp) {
+                        mark[nb] = stamp;
+                        queue[tail++] = nb;
+                    }
+                }
+            }
+            if (depth + 1 <= nLevels) {
+                break;
+            }
+            nLevels = depth + 1;
+            int best = queue[lastLevelStart];
+            for (int k = lastLevelStart; k < tail; k++) {
+                if (degree[queue[k]] < degree[best]) {
+                    best = queue[k];
+                }
+            }
+            if (best == root) {
+                break;
+            }
+            root = best;
+        }
+
+        //Cuthill-McKee: breadth-first search visiting neighbours in order of increasing degree
+        int head = perm.size();
+        perm.push_back(root);
+        level[root] = 0;
+        while (head < (int)perm.size()) {
+            int node = perm[head++];
+            neighbours.clear();
+            for (long long p = adjOffsets[node]; p < adjOffsets[node + 1]; p++) {
+                int nb = adj[p];
+                if (level[nb] < 0) {
+                    level[nb] = level[node] + 1;
+                    neighbours.push_back(nb);
+                }
+            }
+            stable_sort(neighbours.begin(), neighbours.end(), [&](int a, int b){ return degree[a] < degree[b]; });
+            perm.insert(perm.end(), neighbours.begin(), neighbours.end());
+        }
+    }
+    reverse(perm.begin(), perm.end());
+}
@@ -0,0 +1,68 @@
+/*
+* MIT License
+*
+* Copyright (c) 2024 Anders Reenberg Andersen and Jesper Fink Andersen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include <vector>
+
+using namespace std;
+
+#ifndef SPARSELU_H
+#define SPARSELU_H
+
+//Sparse LU factorization P*A*P' = L*U of a square matrix given in CSR format, where P is a
+//reverse Cuthill-McKee ordering of the symmetrized sparsity pattern that limits the fill-in.
+//The factorization is left-looking (Gilbert-Peierls) and does not pivot, which is stable for
+//the diagonally dominant matrices I - discount*P of policy evaluation.
+class SparseLU {
+public:
+
+    SparseLU();
+    SparseLU(const SparseLU& orig);
+    virtual ~SparseLU();
+
+    //METHODS
+    //factorizes the n x n matrix A. Returns false (and leaves the factorization empty) if L and U
+    //would have more than maxNonZeros non-zeros, or if the factorization would take more than
+    //100*maxNonZeros multiply-adds.
+    bool factorize(int n, const vector<long long> &rowOffsets, const vector<int> &cols, const vector<double> &vals, long long maxNonZeros);
+    void solve(vector<double> &b) const; //overwrites b with the solution of A x = b
+    void clear(); //releases the factors
+    bool empty() const;
+    long long numberOfNonZeros() const; //non-zeros of L and U
+
+private:
+
+    //VARIABLES
+    int n;
+    vector<int> perm; //perm[k] is the original index of row/column k
+    vector<long long> Lp, Up; //column offsets of L and U (CSC)
+    vector<int> Li, Ui; //row indices
+    vector<double> Lx, Ux; //values (L has a unit diagonal that is not stored)
+    vector<double> Udiag; //diagonal of U
+
+    //METHODS
+    void reverseCuthillMcKee(const vector<long long> &adjOffsets, const vector<int> &adj);
+
+};
+
+#endif /* SPARSELU_H */
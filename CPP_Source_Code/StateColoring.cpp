@@ -0,0 +1,129 @@
+/*
+* MIT License
+*
+* Copyright (c) 2024 Anders Reenberg Andersen and Jesper Fink Andersen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "StateColoring.h"
+#include <omp.h>
+
+StateColoring::StateColoring():
+    blockSize(1),
+    numberOfStates(0)
+{
+}
+
+StateColoring::StateColoring(const StateColoring& orig):
+    blockSize(orig.blockSize),
+    numberOfStates(orig.numberOfStates),
+    blocks(orig.blocks),
+    colorOffsets(orig.colorOffsets)
+{
+}
+
+StateColoring::~StateColoring() {
+}
+
+void StateColoring::compute(ModelType * mdl){
+    numberOfStates = mdl->getNumberOfStates();
+    StateGraph graph; //successors and predecessors, such that the graph can be treated as undirected
+    graph.compute(mdl);
+
+    //try block sizes from large to small until each color has enough blocks to keep
+    //all threads busy. Large blocks keep the memory access sequential.
+    int minBlocksPerColor = 8 * omp_get_max_threads();
+    vector<int> color;
+    int nColors = 0;
+    for (blockSize = 1024; blockSize >= 1; blockSize /= 4) {
+        int nBlocks = (numberOfStates + blockSize - 1) / blockSize;
+        nColors = colorBlocks(blockSize, graph.succOffsets, graph.succ, graph.predOffsets, graph.pred, color);
+        if (nBlocks >= minBlocksPerColor * nColors) {
+            break;
+        }
+        if (blockSize == 1) {
+            break; //finest possible coloring
+        }
+    }
+
+    //group the blocks by color (counting sort keeps the block order within a color)
+    int nBlocks = color.size();
+    colorOffsets.assign(nColors + 1, 0);
+    for (int bidx = 0; bidx < nBlocks; bidx++) {
+        colorOffsets[color[bidx] + 1]++;
+    }
+    for (int c = 0; c < nColors; c++) {
+        colorOffsets[c + 1] += colorOffsets[c];
+    }
+    blocks.resize(nBlocks);
+    vector<int> pos(colorOffsets.begin(), colorOffsets.end() - 1);
+    for (int bidx = 0; bidx < nBlocks; bidx++) {
+        blocks[pos[color[bidx]]++] = bidx;
+    }
+}
+
+int StateColoring::colorBlocks(int size, const vector<long long> &succOffsets, const vector<int> &succ,
+    const vector<long long> &predOffsets, const vector<int> &pred, vector<int> &color){
+    //greedy coloring of the blocks in order: each block gets the smallest color
+    //not used by any of its (already colored) neighbours. Returns the number of colors.
+    int nBlocks = (numberOfStates + size - 1) / size;
+    color.assign(nBlocks, -1);
+    vector<int> mark(nBlocks + 1, -1); //last block that used a color as a neighbour
+    int nColors = 0;
+    for (int bidx = 0; bidx < nBlocks; bidx++) {
+        int end = (bidx + 1) * size < numberOfStates ? (bidx + 1) * size : numberOfStates;
+        for (int sidx = bidx * size; sidx < end; sidx++) {
+            for (long long k = succOffsets[sidx]; k < succOffsets[sidx + 1]; k++) {
+                int nb = succ[k] / size;
+                if (nb != bidx && color[nb] >= 0) {
+                    mark[color[nb]] = bidx;
+                }
+            }
+            for (long long k = predOffsets[sidx]; k < predOffsets[sidx + 1]; k++) {
+                int nb = pred[k] / size;
+                if (nb != bidx && color[nb] >= 0) {
+                    mark[color[nb]] = bidx;
+                }
+            }
+        }
+        int c = 0;
+        while (mark[c] == bidx) {
+            c++;
+        }
+        color[bidx] = c;
+        if (c == nColors) {
+            nColors++;
+        }
+    }
+    return nColors;
+}
+
+void StateColoring::clear(){
+    blocks.clear();
+    colorOffsets.clear();
+}
+
+bool StateColoring::empty(){
+    return colorOffsets.empty();
+}
+
+int StateColoring::numberOfColors(){
+    return colorOffsets.empty() ? 0 : (int)colorOffsets.size() - 1;
+}
@@ -0,0 +1,77 @@
+/*
+* MIT License
+*
+* Copyright (c) 2024 Anders Reenberg Andersen and Jesper Fink Andersen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "ModelType.h"
+#include "StateGraph.h"
+#include <vector>
+
+using namespace std;
+
+#ifndef STATECOLORING_H
+#define STATECOLORING_H
+
+//Greedy coloring of the state-transition graph, used for parallel Gauss-Seidel and SOR updates.
+//The states are divided into blocks of consecutive states, and two blocks receive different colors
+//if a state in one of them can reach a state in the other in a single transition under any action.
+//The blocks of one color therefore never read each other's values, and they can be updated in
+//place and in parallel, while the states within a block are updated in order as in the serial
+//loops. The block size is the largest one that still leaves enough blocks per color for all threads.
+class StateColoring {
+public:
+
+    StateColoring();
+    StateColoring(const StateColoring& orig);
+    virtual ~StateColoring();
+
+    //VARIABLES
+    int blockSize; //block k contains the states k*blockSize to min((k+1)*blockSize,numberOfStates)-1
+    int numberOfStates;
+    vector<int> blocks; //blocks sorted by color
+    vector<int> colorOffsets; //blocks of color c are blocks[colorOffsets[c]] to blocks[colorOffsets[c+1]-1]
+
+    //METHODS
+    void compute(ModelType * mdl); //computes the coloring of the model
+    void clear(); //resets the coloring, e.g. when a new model is loaded
+    bool empty();
+    int numberOfColors();
+    int blockStart(int block);
+    int blockEnd(int block);
+
+private:
+
+    //METHODS
+    int colorBlocks(int size, const vector<long long> &succOffsets, const vector<int> &succ,
+        const vector<long long> &predOffsets, const vector<int> &pred, vector<int> &color);
+
+};
+
+inline int StateColoring::blockStart(int block){
+    return block * blockSize;
+}
+
+inline int StateColoring::blockEnd(int block){
+    return (block + 1) * blockSize < numberOfStates ? (block + 1) * blockSize : numberOfStates;
+}
+
+#endif /* STATECOLORING_H */
@@ -0,0 +1,183 @@
+/*
+* MIT License
+*
+* Copyright (c) 2024 Anders Reenberg Andersen and Jesper Fink Andersen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "StateGraph.h"
+#include <algorithm>
+
+StateGraph::StateGraph():
+    numberOfStates(0)
+{
+}
+
+StateGraph::StateGraph(const StateGraph& orig):
+    numberOfStates(orig.numberOfStates),
+    succOffsets(orig.succOffsets),
+    succ(orig.succ),
+    predOffsets(orig.predOffsets),
+    pred(orig.pred),
+    predProbs(orig.predProbs),
+    componentOffsets(orig.componentOffsets),
+    componentStates(orig.componentStates)
+{
+}
+
+StateGraph::~StateGraph() {
+}
+
+void StateGraph::clear(){
+    numberOfStates = 0;
+    succOffsets.clear();
+    succ.clear();
+    predOffsets.clear();
+    pred.clear();
+    predProbs.clear();
+    componentOffsets.clear();
+    componentStates.clear();
+}
+
+bool StateGraph::empty(){
+    return succOffsets.empty();
+}
+
+int StateGraph::numberOfComponents(){
+    return componentOffsets.empty() ? 0 : componentOffsets.size() - 1;
+}
+
+void StateGraph::compute(ModelType * mdl){
+    numberOfStates = mdl->getNumberOfStates();
+    RowBuffer buf;
+    TransitionRow row;
+    vector<int> mark(numberOfStates, -1); //last state that visited a state
+    vector<long long> position(numberOfStates); //position of the edge to a state in succ
+
+    //successors of each state (over all actions)
+    succOffsets.assign(numberOfStates + 1, 0);
+    succ.clear();
+    vector<double> succProbs;
+    for (int sidx = 0; sidx < numberOfStates; sidx++) {
+        int nActions = mdl->getNumberOfActions(sidx);
+        for (int aidx = 0; aidx < nActions; aidx++) {
+            row = mdl->getRow(sidx, aidx, buf);
+            for (int cidx = 0; cidx < row.length; cidx++) {
+                int jidx = row.cols[cidx];
+                if (row.probs[cidx] == 0) {
+                    continue;
+                }
+                if (mark[jidx] != sidx) {
+                    mark[jidx] = sidx;
+                    position[jidx] = succ.size();
+                    succ.push_back(jidx);
+                    succProbs.push_back(row.probs[cidx]);
+                } else if (row.probs[cidx] > succProbs[position[jidx]]) {
+                    succProbs[position[jidx]] = row.probs[cidx];
+                }
+            }
+        }
+        succOffsets[sidx + 1] = succ.size();
+    }
+
+    //predecessors of each state (transpose of the successors)
+    predOffsets.assign(numberOfStates + 1, 0);
+    for (long long k = 0; k < (long long)succ.size(); k++) {
+        predOffsets[succ[k] + 1]++;
+    }
+    for (int sidx = 0; sidx < numberOfStates; sidx++) {
+        predOffsets[sidx + 1] += predOffsets[sidx];
+    }
+    pred.resize(succ.size());
+    predProbs.resize(succ.size());
+    vector<long long> predPos(predOffsets.begin(), predOffsets.end() - 1);
+    for (int sidx = 0; sidx < numberOfStates; sidx++) {
+        for (long long k = succOffsets[sidx]; k < succOffsets[sidx + 1]; k++) {
+            long long q = predPos[succ[k]]++;
+            pred[q] = sidx;
+            predProbs[q] = succProbs[k];
+        }
+    }
+}
+
+void StateGraph::computeComponents(){
+    //Tarjan's algorithm with an explicit stack. A component is completed only after all components
+    //reachable from it, so they are found in reverse topological order (downstream components first).
+    componentOffsets.assign(1, 0);
+    componentStates.clear();
+    componentStates.reserve(numberOfStates);
+    vector<int> index(numberOfStates, -1); //order of discovery
+    vector<int> lowLink(numberOfStates);
+    vector<char> onStack(numberOfStates, 0);
+    vector<int> stack; //states of the components that are not completed
+    vector<int> callStack; //states of the depth-first search
+    vector<long long> nextEdge(numberOfStates); //next successor to visit from a state
+    int counter = 0;
+
+    for (int root = 0; root < numberOfStates; root++) {
+        if (index[root] >= 0) {
+            continue;
+        }
+        callStack.push_back(root);
+        while (!callStack.empty()) {
+            int sidx = callStack.back();
+            if (index[sidx] < 0) {
+                index[sidx] = lowLink[sidx] = counter++;
+                nextEdge[sidx] = succOffsets[sidx];
+                stack.push_back(sidx);
+                onStack[sidx] = 1;
+            }
+            bool descended = false;
+            while (nextEdge[sidx] < succOffsets[sidx + 1]) {
+                int jidx = succ[nextEdge[sidx]++];
+                if (index[jidx] < 0) {
+                    callStack.push_back(jidx);
+                    descended = true;
+                    break;
+                } else if (onStack[jidx]) {
+                    lowLink[sidx] = min(lowLink[sidx], index[jidx]);
+                }
+            }
+            if (descended) {
+                continue;
+            }
+
+            //all successors are done
+            callStack.pop_back();
+            if (!callStack.empty()) {
+                int parent = callStack.back();
+                lowLink[parent] = min(lowLink[parent], lowLink[sidx]);
+            }
+            if (lowLink[sidx] == index[sidx]) {
+                //sidx is the root of a component: pop it from the stack (in increasing state order)
+                size_t start = stack.size();
+                do {
+                    start--;
+                    onStack[stack[start]] = 0;
+                } while (stack[start] != sidx);
+                size_t first = componentStates.size();
+                componentStates.insert(componentStates.end(), stack.begin() + start, stack.end());
+                sort(componentStates.begin() + first, componentStates.end());
+                stack.resize(start);
+                componentOffsets.push_back(componentStates.size());
+            }
+        }
+    }
+}
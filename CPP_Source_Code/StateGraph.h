@@ -0,0 +1,62 @@
+/*
+* MIT License
+*
+* Copyright (c) 2024 Anders Reenberg Andersen and Jesper Fink Andersen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "ModelType.h"
+#include <vector>
+
+using namespace std;
+
+#ifndef STATEGRAPH_H
+#define STATEGRAPH_H
+
+//Transition graph of the states over all actions: j is a successor of s if p(j|s,a) > 0 for some
+//action a. Both the successors and the predecessors are stored in CSR format, and each edge holds
+//the largest transition probability over the actions. Self-transitions are included.
+class StateGraph {
+public:
+
+    StateGraph();
+    StateGraph(const StateGraph& orig);
+    virtual ~StateGraph();
+
+    //VARIABLES
+    int numberOfStates;
+    vector<long long> succOffsets; //the successors of s are succ[succOffsets[s]] to succ[succOffsets[s+1]-1]
+    vector<int> succ;
+    vector<long long> predOffsets; //the predecessors of s are pred[predOffsets[s]] to pred[predOffsets[s+1]-1]
+    vector<int> pred;
+    vector<double> predProbs; //predProbs[k] is the largest probability of a transition from pred[k] to s
+    vector<int> componentOffsets; //component c holds the states componentStates[componentOffsets[c]] to componentStates[componentOffsets[c+1]-1]
+    vector<int> componentStates; //states grouped by strongly connected component in reverse topological order
+
+    //METHODS
+    void compute(ModelType * mdl);
+    void computeComponents(); //strongly connected components of the successor graph (Tarjan)
+    int numberOfComponents();
+    void clear(); //resets the graph, e.g. when a new model is loaded
+    bool empty();
+
+};
+
+#endif /* STATEGRAPH_H */
@@ -51,7 +51,6 @@ TBMmodel::TBMmodel(double discount,
 	f(failureProb),
 	fmin(failureProbMin),
 	fhat(failureProbHat),
-	failOddsVec(components,0),
 	sidxMat(numberOfStates, vector<int>(components)),
 	aidxMat(numberOfActions, vector<int>(components)),
 	sidxSumMat(numberOfStates, 0)
@@ -90,11 +89,11 @@ TBMmodel::~TBMmodel() {
 //class functions
 double TBMmodel::reward(int &sidx,int &aidx) {
 	//reward function
-	//int s_i, a_i;
-	r = 0;
-    setUp = false;
-	noFailProb=1;
-	payPenalty = false;
+	int s_i, a_i;
+	double r = 0;
+    bool setUp = false;
+	double noFailProb=1;
+	bool payPenalty = false;
 
     for(int i = 0; i < N; ++i) {
 		s_i = sidxMat[sidx][i];
@@ -120,11 +119,11 @@ double TBMmodel::reward(int &sidx,int &aidx) {
     return r;
 }
 
-double TBMmodel::transProb(int &sidx, int &aidx, int &jidx) {
+double TBMmodel::transProb(int &sidx, int &aidx, int &jidx, double * failOdds) {
 	//probability of transitioning to state j given we are in state s and take action a
-	//int s_i, j_i, a_i;
-	prob = 1;
-	//double failProb;
+	int s_i, j_i, a_i;
+	double prob = 1;
+	double failProb;
 
 	for (int i = 0; i<N; ++i) {
 		j_i = sidxMat[jidx][i];
@@ -145,7 +144,7 @@ double TBMmodel::transProb(int &sidx, int &aidx, int &jidx) {
 				} else { //impossible transition
 					prob *= 0;
 				}
-				failOddsVec[i] = failProb / (1 - failProb); //store for faster computations of other reachable states
+				failOdds[i] = failProb / (1 - failProb); //store for faster computations of other reachable states
 			} else if ((s_i == 0 && j_i != 0) || (s_i == 1 && j_i != 0)) { //impossible transition
 				prob *= 0;
 			}
@@ -153,14 +152,13 @@ double TBMmodel::transProb(int &sidx, int &aidx, int &jidx) {
 			prob *= 0;
 		}
 	}
-	psj = prob; //store transition probability
 	return prob;
 }
 
-void TBMmodel::updateNextState(int &sidx, int &aidx, int &jidx) {
-	//updates pNext and sNext. Assumes that transProb(sidx,aidx,pdidx) has been run,
-	//such that failOddsVec is up to date.
-	//int s_i, j_i, a_i;
+void TBMmodel::updateNextState(int &sidx, int &aidx, int &jidx, double &psj, double * failOdds) {
+	//updates jidx and psj to the next reachable state. Assumes that transProb(sidx,aidx,pdidx,failOdds)
+	//has been run, such that failOdds is up to date.
+	int s_i, j_i, a_i;
 
 	for (int i = 0; i<N; ++i) {
 		j_i = sidxMat[jidx][i];
@@ -168,13 +166,13 @@ void TBMmodel::updateNextState(int &sidx, int &aidx, int &jidx) {
 		a_i = aidxMat[aidx][i];
 		if (a_i==0 && 0<j_i && s_i != 0) { //non-replacements, working component
 			if ((j_i - s_i) == -1) {
-				nextState -= j_i * intPow(L + 1, i); //decrease to 0  (failure)
-				psj *= failOddsVec[i]; //failOdds=failProb/(1-failProb)
+				jidx -= j_i * intPow(L + 1, i); //decrease to 0  (failure)
+				psj *= failOdds[i]; //failOdds=failProb/(1-failProb)
 			}
 			break; //the remaining components don't change
 		} else if (a_i==0 && s_i > 1) { //only if i'th component was able to fail
-			nextState -= (j_i - (s_i - 1))*intPow(L + 1, i); //reset back to s_i-1 (not failed)
-			psj /= failOddsVec[i]; //failOdds=(1-failProb)/failProb
+			jidx -= (j_i - (s_i - 1))*intPow(L + 1, i); //reset back to s_i-1 (not failed)
+			psj /= failOdds[i]; //failOdds=(1-failProb)/failProb
 		}
 	}
 }
@@ -183,9 +181,9 @@ int TBMmodel::postDecisionIdx(int &s, int &a) {
 	//returns state index after replacements
     //replaced components reset to L
     //other components age by 1
-	//int s_i, a_i;
+	int s_i, a_i;
 
-    sf = s;
+    int sf = s;
     for (int i=0; i<N; ++i) {
 		s_i = sidxMat[s][i];
 		a_i = aidxMat[a][i];
@@ -195,10 +193,35 @@ int TBMmodel::postDecisionIdx(int &s, int &a) {
             sf -= intPow(L+1,i); // working components age by 1
         }
     }
-	nextState = sf; //store as the "first" next state
     return sf;
 }
 
+TransitionRow TBMmodel::getRow(int &sidx, int &aidx, RowBuffer &buf) {
+	//enumerates the reachable states, starting from the post-decision state,
+	//and stores them and their probabilities in buf
+	buf.probs.clear();
+	buf.cols.clear();
+	buf.aux.resize(N);
+
+	int sf = postDecisionIdx(sidx, aidx);
+	int jidx = sf;
+	double psj = transProb(sidx, aidx, jidx, buf.aux.data());
+	do {
+		buf.probs.push_back(psj);
+		buf.cols.push_back(jidx);
+		updateNextState(sidx, aidx, jidx, psj, buf.aux.data());
+	} while (jidx != sf);
+
+	TransitionRow row;
+	row.probs = buf.probs.data();
+	row.probsSingle = NULL;
+	row.cols = buf.cols.data();
+	row.colDeltas = NULL;
+	row.colBase = 0;
+	row.length = buf.cols.size();
+	return row;
+}
+
 int TBMmodel::intPow(int a, int b) {
     int i = 1;
     for(int j = 1; j <= b; ++j) i *= a;
@@ -213,31 +236,8 @@ int TBMmodel::getNumberOfStates(){
     return numberOfStates;
 }
 
-void TBMmodel::updateNumberOfActions(int &sidx){	
-}
-
-int TBMmodel::getNumberOfActions(){
-    return numberOfActions;
-}
-
-int * TBMmodel::getNextState(){
-    return &nextState;
-}
-
-double TBMmodel::getPsj(){
-    return psj;
-}
-
-int TBMmodel::getColumnIdx(int &sidx, int &aidx, int &cidx){
-	return 0;
-}
-
-int TBMmodel::getNumberOfJumps(int &sidx, int &aidx){
-	return 0;
-}
-
 int TBMmodel::getNumberOfActions(int &sidx){
-	return 0;
+	return numberOfActions;
 }
 
 //int TBMmodel::getPolicy(int sidx){
@@ -32,7 +32,7 @@
 
 using namespace std;
 
-class TBMmodel : public ModelType{
+class TBMmodel final : public ModelType{
 public:
     
     //constructor and destructor
@@ -68,9 +68,6 @@ public:
     double fhat; // -||-
 
     //auxiliary variables
-    int nextState; //int sNext; //next state to process
-    double psj; //double pNext; //transition probability from state s to j
-	vector<double> failOddsVec; // probability of failing divided by probability of not failing
 	vector<vector<int>> sidxMat; // (sidx,i)'th element contains s_i for state index sidx
 	vector<vector<int>> aidxMat; // (aidx,i)'th element contains a_i for action index aidx
 	vector<int> sidxSumMat; // sidx'th element contains the sum of component states
@@ -79,28 +76,16 @@ public:
         
     //GENERIC METHODS    
     double reward(int &sidx, int &aidx) override;
-    double transProb(int &sidx, int &aidx, int &jidx) override;
-    void updateNextState(int &sidx, int &aidx, int &jidx) override; //void updateNext(int, int, int);
-    int postDecisionIdx(int &sidx, int &aidx) override; //int sFirst(int, int);
+    TransitionRow getRow(int &sidx, int &aidx, RowBuffer &buf) override;
     double getDiscount() override;
     int getNumberOfStates() override;
-    void updateNumberOfActions(int &sidx) override;
-    int getNumberOfActions() override;
     int getNumberOfActions(int &sidx) override;
-    int * getNextState() override;
-    double getPsj() override;
-    int getNumberOfJumps(int &sidx, int &aidx) override; //not used
-    int getColumnIdx(int &sidx, int &aidx, int &cidx) override; //not used
     
     //SPECIAL METHODS
+    int postDecisionIdx(int &sidx, int &aidx); //first state reachable from sidx
+    double transProb(int &sidx, int &aidx, int &jidx, double * failOdds); //also stores failure odds for updateNextState
+    void updateNextState(int &sidx, int &aidx, int &jidx, double &psj, double * failOdds); //moves jidx and psj to the next reachable state
     int intPow(int, int);
-private:
-
-    double r,prob,failProb,noFailProb;
-    int s_i,j_i,a_i,sf;
-    bool setUp,payPenalty;
-
-
 };
 
 #endif /* TBMMODEL_H */
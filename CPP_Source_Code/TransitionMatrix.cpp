@@ -22,9 +22,18 @@
 * SOFTWARE.
 */
 
+#include <algorithm>
+#include <math.h>
+#include <limits>
+
 #include "TransitionMatrix.h"
+#include "NumaPlacement.h"
 
-TransitionMatrix::TransitionMatrix() {
+TransitionMatrix::TransitionMatrix():
+    rowSumError(0),
+    external(false)
+{
+    updateView();
 }
 
 TransitionMatrix::TransitionMatrix(const TransitionMatrix& orig) {
@@ -33,55 +42,234 @@ TransitionMatrix::TransitionMatrix(const TransitionMatrix& orig) {
 TransitionMatrix::~TransitionMatrix() {
 }
 
-double TransitionMatrix::getProb(int& sidx, int& aidx, int& cidx){
-    return probs[sidx][aidx][cidx];
-}
- 
-int TransitionMatrix::getColumn(int& sidx, int& aidx, int& cidx){
-    return cols[sidx][aidx][cidx];
-}
-
 void TransitionMatrix::assignProb(double prob, int& sidx, int& aidx, int& cidx){
-    probs[sidx][aidx][cidx]=prob; 
+    probs[rowOffsets[actionOffsets[sidx]+aidx]+cidx]=prob; 
 }
 
 void TransitionMatrix::assignColumn(int column, int& sidx, int& aidx, int& cidx){
-    cols[sidx][aidx][cidx]=column;
+    cols[rowOffsets[actionOffsets[sidx]+aidx]+cidx]=column;
+}
+
+template <typename T>
+void TransitionMatrix::flattenRows(const vector<vector<vector<T>>> &rows, vector<T> &values){
+    //derive the CSR offsets from the shape of a nested list
+    //and copy its elements into the contiguous array values
+    external = false;
+    actionOffsets.assign(rows.size()+1,0);
+    for (size_t sidx=0; sidx<rows.size(); sidx++){
+        actionOffsets[sidx+1]=actionOffsets[sidx]+rows[sidx].size();
+    }
+    rowOffsets.assign(actionOffsets.back()+1,0);
+    int k=0;
+    for (size_t sidx=0; sidx<rows.size(); sidx++){
+        for (size_t aidx=0; aidx<rows[sidx].size(); aidx++){
+            rowOffsets[k+1]=rowOffsets[k]+rows[sidx][aidx].size();
+            k++;
+        }
+    }
+    values.clear();
+    values.reserve(rowOffsets.back());
+    for (size_t sidx=0; sidx<rows.size(); sidx++){
+        for (size_t aidx=0; aidx<rows[sidx].size(); aidx++){
+            values.insert(values.end(),rows[sidx][aidx].begin(),rows[sidx][aidx].end());
+        }
+    }
 }
 
 void TransitionMatrix::assignProbsFromList(py::list pyProbs){ 
     //cast probabilities directly from Python list
-    probs=pyProbs.cast<vector<vector<vector<double>>>>();
+    flattenRows(pyProbs.cast<vector<vector<vector<double>>>>(),probs);
+    probsSingle.clear();
+    updateView();
 }
     
 void TransitionMatrix::assignColumnsFromList(py::list pyCols){ 
     //cast column indices directly from Python list
-    cols=pyCols.cast<vector<vector<vector<int>>>>();
+    clearCompression();
+    flattenRows(pyCols.cast<vector<vector<vector<int>>>>(),cols);
+    updateView();
 }    
     
+void TransitionMatrix::assignExternalRows(const double * probs, const int * cols, vector<long long> &rowOffsets, vector<int> &actionOffsets){
+    setNumberOfRows(0);
+    this->rowOffsets.swap(rowOffsets);
+    this->actionOffsets.swap(actionOffsets);
+    updateView();
+    view.probs = probs;
+    view.cols = cols;
+    external = true;
+}
+
 void TransitionMatrix::setNumberOfRows(int numberOfStates){
-    probs.resize(numberOfStates);
-    cols.resize(numberOfStates);
+    external = false;
+    actionOffsets.assign(numberOfStates+1,0);
+    rowOffsets.assign(1,0);
+    probs.clear();
+    probsSingle.clear();
+    cols.clear();
+    clearCompression();
+    updateView();
 }
 
 void TransitionMatrix::setNumberOfActions(int nActions, int& sidx){
-    probs[sidx].resize(nActions);
-    cols[sidx].resize(nActions);
+    actionOffsets[sidx+1]=actionOffsets[sidx]+nActions;
+    rowOffsets.resize(actionOffsets[sidx+1]+1,rowOffsets.back());
+    updateView();
 }
 
 void TransitionMatrix::setNumberOfColumns(int nJumps, int& sidx, int& aidx){
-    probs[sidx][aidx].resize(nJumps,-1);
-    cols[sidx][aidx].resize(nJumps,-1);
+    int k=actionOffsets[sidx]+aidx;
+    rowOffsets[k+1]=rowOffsets[k]+nJumps;
+    fill(rowOffsets.begin()+k+2,rowOffsets.end(),rowOffsets[k+1]); //remaining actions of the state start here
+    probs.resize(rowOffsets[k+1],-1);
+    cols.resize(rowOffsets[k+1],-1);
+    updateView();
+}
+
+int TransitionMatrix::numberOfRows(){
+    return view.nStates;
 }
 
-int TransitionMatrix::numberOfColumns(int& sidx, int& aidx){
-    return cols[sidx][aidx].size();
+void TransitionMatrix::compressColumns(){
+    //rows whose columns are within 65536 consecutive states store 16-bit deltas from their smallest column
+    if (view.columnBase != NULL) {
+        return; //already compressed (e.g. a model file written after compression)
+    }
+    clearCompression();
+    long long nRows = view.nRows;
+    long long nnz = view.nnz;
+    const long long * rowOffsets = view.rowOffsets;
+    const int * cols = view.cols;
+    if (nRows <= 0 || nnz == 0 || cols == NULL) {
+        return;
+    }
+    vector<int> base(nRows);
+    long long nWide = 0, wideNnz = 0;
+    #pragma omp parallel for reduction(+:nWide,wideNnz)
+    for (long long k = 0; k < nRows; k++) {
+        int low = 0, high = 0;
+        if (rowOffsets[k] < rowOffsets[k + 1]) {
+            low = *min_element(cols + rowOffsets[k], cols + rowOffsets[k + 1]);
+            high = *max_element(cols + rowOffsets[k], cols + rowOffsets[k + 1]);
+        }
+        if (low >= 0 && (long long)high - low <= 65535) {
+            base[k] = low;
+        } else {
+            base[k] = -1;
+            nWide++;
+            wideNnz += rowOffsets[k + 1] - rowOffsets[k];
+        }
+    }
+    //bytes of the compressed format: base per row, deltas aligned with probs, and the full rows
+    long long compressedBytes = 4 * nRows + 2 * nnz + 4 * wideNnz + 8 * nWide;
+    if (compressedBytes >= 4 * nnz || nWide >= numeric_limits<int>::max()) {
+        return;
+    }
+    columnDeltas.assign(nnz, 0);
+    wideCols.reserve(wideNnz);
+    wideOffsets.reserve(nWide);
+    for (long long k = 0; k < nRows; k++) {
+        if (base[k] < 0) {
+            base[k] = -(int)wideOffsets.size() - 1;
+            wideOffsets.push_back(wideCols.size());
+            wideCols.insert(wideCols.end(), cols + rowOffsets[k], cols + rowOffsets[k + 1]);
+        }
+    }
+    #pragma omp parallel for
+    for (long long k = 0; k < nRows; k++) {
+        if (base[k] >= 0) {
+            for (long long j = rowOffsets[k]; j < rowOffsets[k + 1]; j++) {
+                columnDeltas[j] = (unsigned short)(cols[j] - base[k]);
+            }
+        }
+    }
+    columnBase.swap(base);
+    vector<int>().swap(this->cols); //releases the memory of the full indices
+    if (external) {
+        //the compressed columns are owned, while the probabilities stay external
+        view.cols = NULL;
+        view.columnBase = columnBase.data();
+        view.columnDeltas = columnDeltas.data();
+        view.wideCols = wideCols.data();
+        view.wideOffsets = wideOffsets.data();
+    }
+    updateView();
 }
 
-int TransitionMatrix::numberOfActions(int& sidx){
-    return probs[sidx].size();
+void TransitionMatrix::clearCompression(){
+    columnBase.clear();
+    columnDeltas.clear();
+    wideCols.clear();
+    wideOffsets.clear();
 }
 
-int TransitionMatrix::numberOfRows(){
-    return probs.size();
-}
\ No newline at end of file
+void TransitionMatrix::computeSinglePrecision(){
+    long long nRows = view.nRows;
+    const long long * rowOffsets = view.rowOffsets;
+    const double * probs = view.probs;
+    probsSingle.resize(view.nnz);
+    double maxError = 0;
+    #pragma omp parallel for reduction(max:maxError)
+    for (long long k = 0; k < nRows; k++) {
+        double error = 0;
+        for (long long j = rowOffsets[k]; j < rowOffsets[k + 1]; j++) {
+            probsSingle[j] = (float)probs[j];
+            error += (double)probsSingle[j] - probs[j];
+        }
+        maxError = max(maxError, fabs(error));
+    }
+    rowSumError = maxError;
+}
+
+double TransitionMatrix::singlePrecisionError(){
+    return rowSumError;
+}
+
+bool TransitionMatrix::hasSinglePrecision(){
+    return view.nnz > 0 && (long long)probsSingle.size() == view.nnz;
+}
+
+long long TransitionMatrix::numberOfNonZeros(){
+    return view.nnz;
+}
+
+void TransitionMatrix::place(const vector<int> &stateOffsets){
+    vector<long long> states(stateOffsets.begin(), stateOffsets.end());
+    vector<long long> rows(stateOffsets.size()), elements(stateOffsets.size());
+    for (size_t t = 0; t < stateOffsets.size(); t++) {
+        rows[t] = view.actionOffsets[stateOffsets[t]];
+        elements[t] = view.rowOffsets[rows[t]];
+    }
+    if (hasSinglePrecision()) {
+        NumaPlacement::place(probsSingle, elements);
+    }
+    if (external) {
+        return; //e.g. the pages of a mapped file are shared with the page cache of the operating system
+    }
+    NumaPlacement::place(probs, elements);
+    if (columnBase.empty()) {
+        NumaPlacement::place(cols, elements);
+    } else {
+        NumaPlacement::place(columnDeltas, elements);
+        NumaPlacement::place(columnBase, rows);
+    }
+    NumaPlacement::place(rowOffsets, rows);
+    NumaPlacement::place(actionOffsets, states);
+}
+
+void TransitionMatrix::updateView(){
+    if (external) {
+        return;
+    }
+    view.nStates = actionOffsets.empty() ? 0 : actionOffsets.size() - 1;
+    view.nRows = rowOffsets.empty() ? 0 : rowOffsets.size() - 1;
+    view.nnz = rowOffsets.empty() ? 0 : rowOffsets.back();
+    view.actionOffsets = actionOffsets.data();
+    view.rowOffsets = rowOffsets.data();
+    view.probs = probs.data();
+    view.cols = cols.data();
+    view.columnBase = columnBase.empty() ? NULL : columnBase.data();
+    view.columnDeltas = columnDeltas.data();
+    view.wideCols = wideCols.data();
+    view.wideOffsets = wideOffsets.data();
+}
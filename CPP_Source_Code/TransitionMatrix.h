@@ -23,6 +23,7 @@
 */
 
 #include <vector>
+#include <algorithm>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
@@ -48,9 +49,29 @@ public:
     void assignColumn(int column, int& sidx, int& aidx, int& cidx); //assign single column
     void assignProbsFromList(py::list pyProbs); //cast probabilities directly from Python list
     void assignColumnsFromList(py::list pyCols); //cast column indices directly from Python list
+    //rows whose probabilities and column indices are stored in arrays of the caller (e.g. NumPy arrays), which are
+    //used without copying and must be kept alive until the matrix is reassigned. The offsets are taken over.
+    void assignExternalRows(const double * probs, const int * cols, vector<long long> &rowOffsets, vector<int> &actionOffsets);
     
+    //direct access to the rows of the CSR storage
+    const double * getRowProbs(int& sidx, int& aidx); //pointer to the first probability in row (sidx,aidx)
+    const int * getRowColumns(int& sidx, int& aidx); //pointer to the first column index in row (sidx,aidx). Only for full rows (see compressColumns)
+    int getRowColumnBase(int& sidx, int& aidx); //first column of a compressed row, or -1 if the row stores its full column indices
+    const unsigned short * getRowColumnDeltas(int& sidx, int& aidx); //column indices of a compressed row relative to its base
+    const float * getRowProbsSingle(int& sidx, int& aidx); //the same for the single-precision copy
+    
+    //16-bit column indices relative to the first column of the row, used for all rows whose columns are within
+    //65536 consecutive states if this needs less memory than the full indices. Called once the matrix is loaded.
+    void compressColumns();
+    
+    //single-precision copy of the probabilities, which halves the memory traffic of the row products
+    void computeSinglePrecision(); //creates the copy (kept until the probabilities are reassigned)
+    bool hasSinglePrecision();
+    double singlePrecisionError(); //largest difference between the row sums of the copy and of probs
     
     //set size of array
+    //NB! states must be sized in increasing order, and the actions of a state in increasing order,
+    //since each call appends to the contiguous CSR arrays.
     void setNumberOfRows(int numberOfStates);
     void setNumberOfActions(int nActions, int& sidx);
     void setNumberOfColumns(int nJumps, int& sidx, int& aidx);
@@ -58,14 +79,104 @@ public:
     int numberOfColumns(int& sidx, int& aidx);
     int numberOfActions(int& sidx);
     int numberOfRows();
+    long long numberOfNonZeros();
+
+    //moves the rows of the states stateOffsets[t],...,stateOffsets[t+1]-1 to the NUMA node of thread t
+    void place(const vector<int> &stateOffsets);
     
 private:
 
     //VARIABLES
-    vector<vector<vector<double>>> probs; //non-zero probabilities in the transition matrix (index1: state, index2: action, index3: column/new_state)
-    vector<vector<vector<int>>> cols; //corresponding column indices in the transition matrix (index1: state, index2: action, index3: column/new_state)
+    //compressed sparse row (CSR) storage. Row k=actionOffsets[sidx]+aidx holds the non-zero elements
+    //for state sidx and action aidx, which are found at positions rowOffsets[k],...,rowOffsets[k+1]-1.
+    vector<double> probs; //non-zero probabilities in the transition matrix
+    vector<float> probsSingle; //probs rounded to single precision (empty until computeSinglePrecision)
+    double rowSumError; //see singlePrecisionError
+    vector<int> cols; //corresponding column indices (next states) in the transition matrix (empty if compressed)
+    
+    //compressed column indices. Row k is compressed if columnBase[k] >= 0, in which case its columns are
+    //columnBase[k] + columnDeltas[rowOffsets[k]+c]. Otherwise it is the full row w = -columnBase[k]-1,
+    //whose columns are wideCols[wideOffsets[w]+c].
+    vector<int> columnBase; //empty if the columns are not compressed
+    vector<unsigned short> columnDeltas;
+    vector<int> wideCols;
+    vector<long long> wideOffsets;
+    vector<long long> rowOffsets; //offset of each (state,action) row in probs and cols
+    vector<int> actionOffsets; //offset of the first row of each state in rowOffsets
+    
+    //the arrays are read through this view, which points into the vectors above, into the pages of
+    //a mapped model file (see ModelFile), or into arrays given by the caller (see assignExternalRows)
+    struct View {
+        int nStates;
+        long long nRows;
+        long long nnz;
+        const int * actionOffsets;
+        const long long * rowOffsets;
+        const double * probs;
+        const int * cols;
+        const int * columnBase; //NULL if the columns are not compressed
+        const unsigned short * columnDeltas;
+        const int * wideCols;
+        const long long * wideOffsets;
+    } view;
+    bool external; //the view points into arrays that are not owned by the matrix (see view)
+    
+    //METHODS
+    void clearCompression();
+    void updateView();
+    template <typename T> void flattenRows(const vector<vector<vector<T>>> &rows, vector<T> &values);
+    
+    friend class ModelFile;
     
 };
 
+//element and row accessors are defined here so that they can be inlined into the solver kernels
+
+inline double TransitionMatrix::getProb(int& sidx, int& aidx, int& cidx){
+    return view.probs[view.rowOffsets[view.actionOffsets[sidx]+aidx]+cidx];
+}
+ 
+inline int TransitionMatrix::getColumn(int& sidx, int& aidx, int& cidx){
+    int k=view.actionOffsets[sidx]+aidx;
+    if (view.columnBase==NULL){
+        return view.cols[view.rowOffsets[k]+cidx];
+    }
+    int base=view.columnBase[k];
+    return base>=0 ? base+view.columnDeltas[view.rowOffsets[k]+cidx] : view.wideCols[view.wideOffsets[-base-1]+cidx];
+}
+
+inline const double * TransitionMatrix::getRowProbs(int& sidx, int& aidx){
+    return view.probs+view.rowOffsets[view.actionOffsets[sidx]+aidx];
+}
+
+inline const float * TransitionMatrix::getRowProbsSingle(int& sidx, int& aidx){
+    return probsSingle.data()+view.rowOffsets[view.actionOffsets[sidx]+aidx];
+}
+
+inline const int * TransitionMatrix::getRowColumns(int& sidx, int& aidx){
+    int k=view.actionOffsets[sidx]+aidx;
+    if (view.columnBase==NULL){
+        return view.cols+view.rowOffsets[k];
+    }
+    return view.wideCols+view.wideOffsets[-view.columnBase[k]-1];
+}
+
+inline int TransitionMatrix::getRowColumnBase(int& sidx, int& aidx){
+    return view.columnBase==NULL ? -1 : max(view.columnBase[view.actionOffsets[sidx]+aidx],-1);
+}
+
+inline const unsigned short * TransitionMatrix::getRowColumnDeltas(int& sidx, int& aidx){
+    return view.columnDeltas+view.rowOffsets[view.actionOffsets[sidx]+aidx];
+}
+
+inline int TransitionMatrix::numberOfColumns(int& sidx, int& aidx){
+    int k=view.actionOffsets[sidx]+aidx;
+    return view.rowOffsets[k+1]-view.rowOffsets[k];
+}
+
+inline int TransitionMatrix::numberOfActions(int& sidx){
+    return view.actionOffsets[sidx+1]-view.actionOffsets[sidx];
+}
+
 #endif /* TRANSITIONMATRIX_H */
 
@@ -0,0 +1,140 @@
+/*
+* MIT License
+*
+* Copyright (c) 2024 Anders Reenberg Andersen and Jesper Fink Andersen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "WorkPartition.h"
+#include <algorithm>
+#include <omp.h>
+
+//work of a row in addition to its nonzeros (reward, policy, and loop overhead)
+static const int rowOverhead = 4;
+
+WorkPartition::WorkPartition():
+    nThreads(0)
+{
+}
+
+WorkPartition::WorkPartition(const WorkPartition& orig):
+    improvementChunks(orig.improvementChunks),
+    evaluationChunks(orig.evaluationChunks),
+    nThreads(orig.nThreads),
+    actionOffsets(orig.actionOffsets),
+    rowLengths(orig.rowLengths),
+    work(orig.work)
+{
+}
+
+WorkPartition::~WorkPartition() {
+}
+
+void WorkPartition::compute(ModelType * mdl){
+    nThreads = omp_get_max_threads();
+    int nStates = mdl->getNumberOfStates();
+    actionOffsets.assign(nStates + 1, 0);
+    for (int sidx = 0; sidx < nStates; sidx++) {
+        actionOffsets[sidx + 1] = actionOffsets[sidx] + mdl->getNumberOfActions(sidx);
+    }
+    rowLengths.resize(actionOffsets[nStates]);
+    #pragma omp parallel
+    {
+        RowBuffer buf; //thread-local row storage
+        #pragma omp for schedule(dynamic, 256)
+        for (int sidx = 0; sidx < nStates; sidx++) {
+            int nActions = actionOffsets[sidx + 1] - actionOffsets[sidx];
+            for (int aidx = 0; aidx < nActions; aidx++) {
+                rowLengths[actionOffsets[sidx] + aidx] = mdl->getRow(sidx, aidx, buf).length;
+            }
+        }
+    }
+
+    work.assign(nStates + 1, 0);
+    for (int sidx = 0; sidx < nStates; sidx++) {
+        long long stateWork = 0;
+        for (long long k = actionOffsets[sidx]; k < actionOffsets[sidx + 1]; k++) {
+            stateWork += rowLengths[k] + rowOverhead;
+        }
+        work[sidx + 1] = work[sidx] + stateWork;
+    }
+    split(improvementChunks);
+    evaluationChunks = improvementChunks; //until the policy is known
+}
+
+void WorkPartition::computeEvaluation(const vector<int> &policy){
+    //prefix sums of the work in two parallel passes over the improvement chunks
+    int nChunks = improvementChunks.size() - 1;
+    vector<long long> chunkWork(nChunks + 1, 0);
+    #pragma omp parallel
+    {
+        #pragma omp for
+        for (int k = 0; k < nChunks; k++) {
+            long long sum = 0;
+            for (int sidx = improvementChunks[k]; sidx < improvementChunks[k + 1]; sidx++) {
+                sum += rowLengths[actionOffsets[sidx] + policy[sidx]] + rowOverhead;
+                work[sidx + 1] = sum;
+            }
+            chunkWork[k + 1] = sum;
+        }
+        #pragma omp single
+        for (int k = 0; k < nChunks; k++) {
+            chunkWork[k + 1] += chunkWork[k];
+        }
+        #pragma omp for
+        for (int k = 0; k < nChunks; k++) {
+            for (int sidx = improvementChunks[k]; sidx < improvementChunks[k + 1]; sidx++) {
+                work[sidx + 1] += chunkWork[k];
+            }
+        }
+    }
+    split(evaluationChunks);
+}
+
+void WorkPartition::split(vector<int> &chunks){
+    //chunk k ends at the first state where the prefix sum reaches k/nChunks of the total work
+    int nStates = work.size() - 1;
+    int nChunks = numberOfChunks();
+    chunks.assign(nChunks + 1, nStates);
+    chunks[0] = 0;
+    double total = work[nStates];
+    for (int k = 1; k < nChunks; k++) {
+        long long target = (long long)(total * k / nChunks);
+        chunks[k] = lower_bound(work.begin(), work.end(), target) - work.begin();
+        chunks[k] = max(chunks[k - 1], min(chunks[k], nStates));
+    }
+}
+
+void WorkPartition::clear(){
+    nThreads = 0;
+    improvementChunks.clear();
+    evaluationChunks.clear();
+    actionOffsets.clear();
+    rowLengths.clear();
+    work.clear();
+}
+
+bool WorkPartition::empty(){
+    return improvementChunks.empty() || nThreads != omp_get_max_threads();
+}
+
+int WorkPartition::numberOfChunks(){
+    return chunksPerThread * nThreads;
+}
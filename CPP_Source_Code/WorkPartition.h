@@ -0,0 +1,71 @@
+/*
+* MIT License
+*
+* Copyright (c) 2024 Anders Reenberg Andersen and Jesper Fink Andersen
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*/
+
+#include "ModelType.h"
+#include <vector>
+
+using namespace std;
+
+#ifndef WORKPARTITION_H
+#define WORKPARTITION_H
+
+//Division of the states into chunks of consecutive states with about the same amount of work, used
+//by the parallel loops over all states (standard updates). The work of a row is its number of nonzeros
+//plus a fixed overhead. The improvement chunks balance the rows of all actions, and the evaluation
+//chunks the rows of the actions of the current policy. There are chunksPerThread chunks per thread, so
+//the static schedule gives each thread consecutive chunks with the same work, and a dynamic schedule
+//(work stealing) has enough chunks to even out the remaining differences.
+class WorkPartition {
+public:
+
+    WorkPartition();
+    WorkPartition(const WorkPartition& orig);
+    virtual ~WorkPartition();
+
+    //VARIABLES
+    static const int chunksPerThread = 8;
+    vector<int> improvementChunks; //chunk k contains the states improvementChunks[k] to improvementChunks[k+1]-1
+    vector<int> evaluationChunks; //the same for the rows of the policy
+
+    //METHODS
+    void compute(ModelType * mdl); //row lengths and improvement chunks for the current number of threads
+    void computeEvaluation(const vector<int> &policy); //evaluation chunks of the policy
+    void clear(); //resets the partition, e.g. when a new model is loaded
+    bool empty(); //also true if the number of threads has changed since compute
+    int numberOfChunks();
+
+private:
+
+    //VARIABLES
+    int nThreads;
+    vector<long long> actionOffsets; //the row of state s and action a is rowLengths[actionOffsets[s]+a]
+    vector<int> rowLengths;
+    vector<long long> work; //prefix sums of the work of the states
+
+    //METHODS
+    void split(vector<int> &chunks); //chunks of equal work from the prefix sums in work
+
+};
+
+#endif /* WORKPARTITION_H */
@@ -20,15 +20,18 @@ double MyModel::reward(int &sidx,int &aidx) {
 	return 0;
 }
 
-double MyModel::transProb(int &sidx, int &aidx, int &jidx) {
-    return 0;
-}
-
-void MyModel::updateNextState(int &sidx, int &aidx, int &jidx) {
-}
+TransitionRow MyModel::getRow(int &sidx, int &aidx, RowBuffer &buf) {
+    //store the states reachable from sidx under action aidx in buf.cols,
+    //and their probabilities in buf.probs. The solver calls getRow from
+    //several threads, so use buf (and buf.aux) rather than class members.
+    buf.probs.clear();
+    buf.cols.clear();
 
-int MyModel::postDecisionIdx(int &sidx, int &aidx) {
-    return 0;
+    TransitionRow row;
+    row.probs = buf.probs.data();
+    row.cols = buf.cols.data();
+    row.length = buf.cols.size();
+    return row;
 }
 
 double MyModel::getDiscount(){
@@ -39,29 +42,6 @@ int MyModel::getNumberOfStates(){
     return numberOfStates;
 }
 
-void MyModel::updateNumberOfActions(int &sidx){	
-}
-
-int MyModel::getNumberOfActions(){
-    return numberOfActions;
-}
-
-int * MyModel::getNextState(){
-    return &nextState;
-}
-
-double MyModel::getPsj(){
-    return psj;
-}
-
-int MyModel::getColumnIdx(int &sidx, int &aidx, int &cidx){
-	return 0;
-}
-
-int MyModel::getNumberOfJumps(int &sidx, int &aidx){
-	return 0;
-}
-
 int MyModel::getNumberOfActions(int &sidx){
-	return 0;
+    return numberOfActions;
 }
\ No newline at end of file
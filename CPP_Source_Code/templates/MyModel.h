@@ -10,7 +10,11 @@
 
 using namespace std;
 
-class MyModel : public ModelType{
+//NB! To solve the model, add an explicit instantiation of the solver
+//for MyModel at the end of ModifiedPolicyIteration.cpp:
+//template void ModifiedPolicyIteration::solve<MyModel>(MyModel * mdl, Policy * ply, ValueVector * vv);
+
+class MyModel final : public ModelType{
 public:
     
     //constructor and destructor
@@ -30,23 +34,15 @@ public:
 
 
     //MANDATORY VARIABLES
-    double discount,psj;
-    int numberOfStates,numberOfActions,nextState;
+    double discount;
+    int numberOfStates,numberOfActions;
     
     //MANDATORY METHODS (DO NOT CHANGE)   
     double reward(int &sidx, int &aidx) override;
-    double transProb(int &sidx, int &aidx, int &jidx) override;
-    void updateNextState(int &sidx, int &aidx, int &jidx) override;
-    int postDecisionIdx(int &sidx, int &aidx) override;
+    TransitionRow getRow(int &sidx, int &aidx, RowBuffer &buf) override;
     double getDiscount() override;
     int getNumberOfStates() override;
-    void updateNumberOfActions(int &sidx) override;
-    int getNumberOfActions() override;
     int getNumberOfActions(int &sidx) override;
-    int * getNextState() override;
-    double getPsj() override;
-    int getNumberOfJumps(int &sidx, int &aidx) override;
-    int getColumnIdx(int &sidx, int &aidx, int &cidx) override;
     
 private:
 
@@ -14,7 +14,9 @@ class model:
     Creates an MDPSolver object.
 
     This class provides methods to initialize, solve, and return results
-    from an MDP model.
+    from an MDP model. The Python interpreter lock is released while a model is
+    solved, so separate models can be solved concurrently from Python threads.
+    Calls on a model that is being solved by another thread wait for the solve.
     """
 
     def __init__(self):
@@ -39,6 +41,15 @@ class model:
         postProcessing=True,
         makeFinalCheck=True,
         parallel=True,
+        evaluation="iterative",
+        decompose=False,
+        andersonDepth=0,
+        adaptiveParIter=False,
+        adaptiveSOR=False,
+        pinThreads=False,
+        workStealing=False,
+        mixedPrecision=False,
+        actionElimination=True,
     ):
         """
         Derive an epsilon-optimal policy for the selected MDP model.
@@ -46,7 +57,7 @@ class model:
         Args:
             algorithm (str): Algorithm to use.
             tolerance (float): Convergence threshold for the algorithm.
-            update (str): The value-update method.
+            update (str): The value-update method. 'async' is a parallel variant of Gauss-Seidel value iteration, where each thread updates its own block of states without waiting for the other threads. With PI and MPI, or without parallel computation, 'async' is the same as 'gs'. 'prioritized' is Gauss-Seidel value iteration with prioritized sweeping, where the states are updated in order of their Bellman residual and only when the values of their successors have changed. It is computed serially and is intended for sparse models where most states converge early. With PI and MPI, or with the average reward criterion, 'prioritized' is the same as 'gs'.
             criterion (str): The optimality criterion.
             parIterLim (int): The partial evaluation limit employed in the modified policy iteration algorithm.
             SORrelaxation (float): Relaxation parameter for the Successive Over-Relaxation method.
@@ -55,7 +66,16 @@ class model:
             verbose (bool): If True, prints solver progress to console.
             postProcessing (bool): If True, performs post-processing after solving.
             makeFinalCheck (bool): If True, makes a final check of the value vector. This process checks if the resulting values are reasonable.
-            parallel (bool): If True, enables parallel computation for faster solving. This option is only available for the custom MDP model with standard updates.
+            parallel (bool): If True, enables parallel computation for faster solving. With Gauss-Seidel or SOR updates, the states are updated in parallel in the order of a coloring of the state-transition graph. This order differs from the serial order, and SOR may not converge in it although it converges serially. If the residual of the parallel SOR updates grows or stops decreasing, the relaxation is therefore reduced towards 1 (Gauss-Seidel), which converges in any order. The relaxation used at the end is returned by getSORrelaxation.
+            evaluation (str): The policy evaluation method in PI and MPI. 'iterative' uses value function updates. 'gmres' and 'bicgstab' solve the linear system of the policy with a Krylov method, which needs far fewer iterations for discount factors close to 1. In MPI, parIterLim limits the number of matrix-vector products. 'direct' evaluates each policy exactly with a sparse LU factorization, which is updated (low-rank) when the policy changes in a few states only. It is intended for PI on models with up to about 1M states and a banded or otherwise local transition structure, and falls back to 'gmres' if the factorization needs too much memory. Only available with the discounted reward criterion.
+            decompose (bool): If True, the strongly connected components of the state-transition graph are solved one at a time before the selected algorithm starts, beginning with the components that other states lead to. States on transient chains are then solved in a single update each. Only available with the discounted reward criterion.
+            andersonDepth (int): If positive, VI with standard updates is accelerated with Anderson mixing of the last andersonDepth iterates (e.g. 5), which reduces the number of iterations for discount factors close to 1 at the cost of 2*andersonDepth extra value vectors. An extrapolation that does not reduce the residual is replaced by the plain value update. Only available with the discounted reward criterion.
+            adaptiveParIter (bool): If True, MPI chooses the number of partial evaluation sweeps in each iteration, up to parIterLim. The evaluation is kept short while many states change action, and long when the policy is stable or the policy improvement is expensive compared to an evaluation sweep (e.g. with many actions). The chosen limits are returned by getParIterLims. Only used with evaluation='iterative'.
+            adaptiveSOR (bool): If True, the SOR relaxation is chosen during the solve instead of SORrelaxation. The first sweeps are Gauss-Seidel sweeps, and the reduction of their residuals determines the relaxation, which is reduced again if the residual of the relaxed sweeps grows or stops decreasing. The relaxation is limited to [1, 1.9], and the chosen value is returned by getSORrelaxation. Only used with update='sor' and the discounted reward criterion.
+            pinThreads (bool): If True, each thread of the parallel computation is bound to one CPU (Linux only), including the Python thread that calls solve. The threads can run on their previous CPUs again when the solve is done. The threads are not bound while the threads of a solve of another model are, since both solves would use the same CPUs. On machines with several NUMA nodes, the transition matrix, the value vector, and the policy are always moved to the nodes of the threads that process them in parallel solves, and pinning keeps the threads on these nodes.
+            workStealing (bool): If True, the threads of a parallel solve with standard updates take the chunks of states one at a time instead of a fixed range of chunks each. The chunks always contain about the same number of nonzero transition probabilities, so this only helps if the threads are slowed down unevenly, e.g. by other processes or by the memory access of the rows.
+            mixedPrecision (bool): If True, the solver first iterates with the transition probabilities rounded to single precision, which reduces the memory traffic of the updates, and then continues with the exact probabilities until the tolerance is reached. The sums are always computed in double precision. The single-precision copy of the probabilities is kept with the model, so it needs 50% more memory for the probabilities. Only used for models given by mdp, with update='standard', an evaluation other than 'direct', and the discounted reward criterion.
+            actionElimination (bool): If True, actions that the MacQueen bounds on the optimal values prove suboptimal are not evaluated again in the rest of the solve. An action is only removed if its value is more than discount*(upper bound - lower bound) below the best action of its state, so optimal actions are kept. Only used with update='standard' and the discounted reward criterion.
 
         Returns:
             None
@@ -73,6 +93,15 @@ class model:
             postProcessing=postProcessing,
             makeFinalCheck=makeFinalCheck,
             parallel=parallel,
+            evaluation=evaluation,
+            decompose=decompose,
+            andersonDepth=andersonDepth,
+            adaptiveParIter=adaptiveParIter,
+            adaptiveSOR=adaptiveSOR,
+            pinThreads=pinThreads,
+            workStealing=workStealing,
+            mixedPrecision=mixedPrecision,
+            actionElimination=actionElimination,
         )
 
     def getRuntime(self):
@@ -134,6 +163,71 @@ class model:
         """
         return self.mdl.getValueVector()
 
+    def getPolicyArray(self):
+        """
+        Get the entire optimized policy as a NumPy array, which views the policy of the model without copying it.
+
+        The array is read-only and keeps the policy of the solve it was taken from, even if the model is solved again.
+
+        Returns:
+            numpy.ndarray: Optimized policy (int32).
+        """
+        return self.mdl.getPolicyArray()
+
+    def getValueVectorArray(self):
+        """
+        Get the entire optimized value vector as a NumPy array, which views the value vector of the model without copying it.
+
+        The array is read-only and keeps the values of the solve it was taken from, even if the model is solved again.
+
+        Returns:
+            numpy.ndarray: Optimized value vector (float64).
+        """
+        return self.mdl.getValueVectorArray()
+
+    def getActions(self, stateIndices):
+        """
+        Get the actions from the optimized policy for several states.
+
+        Args:
+            stateIndices (list or numpy.ndarray): Indices of the states.
+
+        Returns:
+            numpy.ndarray: Actions for the given states, with the shape of stateIndices. The action of an invalid state index is -1.
+        """
+        return self.mdl.getActions(stateIndices=stateIndices)
+
+    def getParIterLims(self):
+        """
+        Get the partial evaluation limits chosen in each iteration of the last adaptive MPI solve (adaptiveParIter=True).
+
+        Returns:
+            list: Partial evaluation limit of each iteration.
+        """
+        return self.mdl.getParIterLims()
+
+    def getSORrelaxation(self):
+        """
+        Get the SOR relaxation used at the end of the last solve. With adaptiveSOR=True, this is the relaxation chosen by the solver. With parallel SOR updates, it may be smaller than SORrelaxation (see solve).
+
+        Returns:
+            float: SOR relaxation parameter.
+        """
+        return self.mdl.getSORrelaxation()
+
+    def getTransitionRow(self, stateIndex=0, actionIndex=0):
+        """
+        Get the transition probabilities of a state and an action as the solver reads them.
+
+        Args:
+            stateIndex (int): Index of the state.
+            actionIndex (int): Index of the action.
+
+        Returns:
+            list: (column, probability) pairs of the next states. Empty for an invalid state or action.
+        """
+        return self.mdl.getTransitionRow(stateIndex=stateIndex, actionIndex=actionIndex)
+
     def saveToFile(self, fileName="result.csv", type="policy"):
         """
         Save the optimized policy or value vector to a file.
@@ -147,6 +241,20 @@ class model:
         """
         return self.mdl.saveToFile(fileName=fileName, type=type)
 
+    def saveModel(self, fileName="model.bin"):
+        """
+        Save the general MDP model (rewards and transition probabilities) to a binary model file, which can be loaded with mdp(modelFromFile=...).
+
+        The file contains the arrays of the model as they are stored in memory, in the byte order of this machine. The format is described in ModelFile.h.
+
+        Args:
+            fileName (str): Name of the output file.
+
+        Returns:
+            None
+        """
+        return self.mdl.saveModel(fileName=fileName)
+
     def mdp(
         self,
         discount=0.99,
@@ -158,20 +266,24 @@ class model:
         tranMatProbs=list(),
         tranMatColumns=list(),
         tranMatFromFile="transitions.csv",
+        modelFromFile="",
+        tranMatSparse=None,
     ):
         """
         Define the generic MDP model.
 
         Args:
             discount (float): Discount factor.
-            rewards (list): A 2D-list containing the reward (float) of a particular action in a particular state.
-            rewardsElementwise (list): Alternative reward format. A 2D-list where each row corresponds to a combination of a state and an action.
+            rewards (list or numpy.ndarray): A 2D-list containing the reward (float) of a particular action in a particular state. A 2D NumPy array (states x actions) is used without copying, so it must not be modified while the model is in use.
+            rewardsElementwise (list or numpy.ndarray): Alternative reward format. A 2D-list or 2D NumPy array where each row corresponds to a combination of a state and an action.
             rewardsFromFile (str): Load the rewards from a comma-separated (,) file.
-            tranMatWithZeros (list): A 3D-list containing the transition probabilities.
-            tranMatElementwise (list): Sparse transition probabilities (option 1). A 2D-list where each row corresponds to a combination of a current state, an action, and a next state.
+            tranMatWithZeros (list or numpy.ndarray): A 3D-list or 3D NumPy array (states x actions x states) containing the transition probabilities.
+            tranMatElementwise (list or numpy.ndarray): Sparse transition probabilities (option 1). A 2D-list or 2D NumPy array where each row corresponds to a combination of a current state, an action, and a next state.
             tranMatProbs (list): Sparse transition probabilities (option 2, part 1). A 3D-list containing the non-zero transition probabilities.
             tranMatColumns (list): Sparse transition probabilities (option 2, part 2). A 3D-list containing the columns of the non-zero transition probabilities.
             tranMatFromFile (str): Load the transition probabilities from a comma-separated (,) file.
+            tranMatSparse (scipy.sparse matrix or list): Sparse transition probabilities (option 3). Either a list with one SciPy sparse matrix (states x states) per action, or a single matrix with (states*actions) rows, where row state*actions+action contains the probabilities of the action in the state. All states must have the same number of actions. Matrices in other formats than CSR are converted with tocsr(). The probabilities and column indices of a single CSR matrix with float64 data and int32 indices are used without copying, so the matrix must not be modified while the model is in use.
+            modelFromFile (str): Load the rewards and the transition probabilities from a binary model file written by saveModel, instead of the options above. The file is mapped into memory rather than read, so loading takes no time and the operating system only reads the parts of the file that the solver uses. The file must not be modified while the model is in use.
 
         Returns:
             None
@@ -186,4 +298,6 @@ class model:
             tranMatProbs=tranMatProbs,
             tranMatColumns=tranMatColumns,
             tranMatFromFile=tranMatFromFile,
+            modelFromFile=modelFromFile,
+            tranMatSparse=tranMatSparse,
         )
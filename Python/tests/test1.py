@@ -1,5 +1,8 @@
 import random
 import sys
+import tempfile
+import struct
+import concurrent.futures
 import os
 import numpy as np
 from random import randint
@@ -7,6 +10,7 @@ project_root = os.path.dirname(os.path.abspath(__file__))
 src_path = os.path.join(project_root, "..", "src")
 sys.path.append(os.path.abspath(src_path))
 import mdpsolver
+from mdpsolver import solvermodule
 
 # TEST 1
 # Simple MDP with 3 states and 2 actions in each state.
@@ -283,10 +287,319 @@ if not np.array_equal(np.array(mdl3d.getPolicy()), np.array([1, 1, 0])):
     sys.exit("Model 3d failed!")
 if not np.array_equal(
     np.round(np.array(mdl3d.getValueVector()), 3),
-    np.round(np.array([206.69740452375487, 222.30968454932525, 305.91165352015094]), 3),
+    np.round(np.array([200.00127192706978, 212.86686213417138, 298.7091756904488]), 3),
 ):
     sys.exit("Model 3d failed!")
 
+# Model 1e (SOR, parallel)
+mdl1e = mdpsolver.model()
+mdl1e.mdp(discount=0.95, rewards=rewards, tranMatWithZeros=tranMatWithZeros)
+mdl1e.solve(
+    algorithm="mpi",
+    update="sor",
+    SORrelaxation=1.01,
+    parallel=True,
+    initPolicy=initPolicy,
+)
+if not np.array_equal(np.array(mdl1e.getPolicy()), np.array([1, 1, 0])):
+    sys.exit("Model 1e failed!")
+if not np.array_equal(
+    np.round(np.array(mdl1e.getValueVector()), 3),
+    np.round(np.array([200.00127021272166, 212.86686059325598, 298.70917425463125]), 3),
+):
+    sys.exit("Model 1e failed!")
+
+# Model 3e (Gauss-Seidel, parallel)
+mdl3e = mdpsolver.model()
+mdl3e.mdp(discount=0.95, rewards=rewards, tranMatWithZeros=tranMatWithZeros)
+mdl3e.solve(algorithm="vi", update="gs", parallel=True)
+if not np.array_equal(np.array(mdl3e.getPolicy()), np.array([1, 1, 0])):
+    sys.exit("Model 3e failed!")
+if not np.array_equal(
+    np.round(np.array(mdl3e.getValueVector()), 3),
+    np.round(np.array([200.0010604606014, 212.86664512773723, 298.7089561808565]), 3),
+):
+    sys.exit("Model 3e failed!")
+
+# Model 3f (block-asynchronous Gauss-Seidel, parallel)
+mdl3f = mdpsolver.model()
+mdl3f.mdp(discount=0.95, rewards=rewards, tranMatWithZeros=tranMatWithZeros)
+mdl3f.solve(algorithm="vi", update="async", parallel=True)
+if not np.array_equal(np.array(mdl3f.getPolicy()), np.array([1, 1, 0])):
+    sys.exit("Model 3f failed!")
+if not np.array_equal(
+    np.round(np.array(mdl3f.getValueVector()), 3),
+    np.round(np.array([200.0010604606014, 212.86664512773723, 298.7089561808565]), 3),
+):
+    sys.exit("Model 3f failed!")
+
+# Model 3g (prioritized sweeping)
+mdl3g = mdpsolver.model()
+mdl3g.mdp(discount=0.95, rewards=rewards, tranMatWithZeros=tranMatWithZeros)
+mdl3g.solve(algorithm="vi", update="prioritized")
+if not np.array_equal(np.array(mdl3g.getPolicy()), np.array([1, 1, 0])):
+    sys.exit("Model 3g failed!")
+if not np.array_equal(
+    np.round(np.array(mdl3g.getValueVector()), 3),
+    np.round(np.array([200.0010739636632, 212.8666574309596, 298.70896943123853]), 3),
+):
+    sys.exit("Model 3g failed!")
+
+# Model 3h (Anderson acceleration)
+mdl3h = mdpsolver.model()
+mdl3h.mdp(discount=0.95, rewards=rewards, tranMatWithZeros=tranMatWithZeros)
+mdl3h.solve(algorithm="vi", update="standard", andersonDepth=5)
+if not np.array_equal(np.array(mdl3h.getPolicy()), np.array([1, 1, 0])):
+    sys.exit("Model 3h failed!")
+if not np.array_equal(
+    np.round(np.array(mdl3h.getValueVector()), 3),
+    np.round(np.array([200.0013893713055, 212.86696769711287, 298.7092740534861]), 3),
+):
+    sys.exit("Model 3h failed!")
+
+# Model 1h (adaptive partial evaluation limit)
+mdl1h = mdpsolver.model()
+mdl1h.mdp(discount=0.95, rewards=rewards, tranMatWithZeros=tranMatWithZeros)
+mdl1h.solve(algorithm="mpi", update="standard", adaptiveParIter=True)
+if not np.array_equal(np.array(mdl1h.getPolicy()), np.array([1, 1, 0])):
+    sys.exit("Model 1h failed!")
+if not np.array_equal(
+    np.round(np.array(mdl1h.getValueVector()), 3),
+    np.round(np.array([200.00080390163885, 212.86639033592616, 298.708722381461]), 3),
+):
+    sys.exit("Model 1h failed!")
+if len(mdl1h.getParIterLims()) == 0 or min(mdl1h.getParIterLims()) < 1:
+    sys.exit("Model 1h failed!")
+
+# Model 3i (adaptive SOR relaxation)
+mdl3i = mdpsolver.model()
+mdl3i.mdp(discount=0.95, rewards=rewards, tranMatWithZeros=tranMatWithZeros)
+mdl3i.solve(algorithm="vi", update="sor", adaptiveSOR=True)
+if not np.array_equal(np.array(mdl3i.getPolicy()), np.array([1, 1, 0])):
+    sys.exit("Model 3i failed!")
+if not np.array_equal(
+    np.round(np.array(mdl3i.getValueVector()), 3),
+    np.round(np.array([200.00132445970473, 212.86691119662186, 298.70922254599003]), 3),
+):
+    sys.exit("Model 3i failed!")
+if mdl3i.getSORrelaxation() < 1 or mdl3i.getSORrelaxation() > 1.9:
+    sys.exit("Model 3i failed!")
+
+# Model 1p, 3j (action elimination). In state 1, the first action is optimal by 2^-40. In the first
+# sweep, its value is 2^-40 less than the elimination threshold below the best value, and this gap
+# would be rounded above the threshold in single precision.
+gapTie = 0.25 + 3 * 2.0**-27
+rewardsTie = [[1 + gapTie], [1 - gapTie + 2.0**-40, 1]]
+tranMatTie = [[[1, 0]], [[1, 0], [0, 1]]]
+for algorithm in ["mpi", "vi"]:
+    for actionElimination in [True, False]:
+        mdlTie = mdpsolver.model()
+        mdlTie.mdp(discount=0.5, rewards=rewardsTie, tranMatWithZeros=tranMatTie)
+        mdlTie.solve(
+            algorithm=algorithm,
+            update="standard",
+            tolerance=1e-14,
+            initValueVector=[0, 0],
+            actionElimination=actionElimination,
+        )
+        if not np.array_equal(np.array(mdlTie.getPolicy()), np.array([0, 0])):
+            sys.exit("Model " + ("1p" if algorithm == "mpi" else "3j") + " failed!")
+
+# Model 1i (threads bound to CPUs)
+cpus1i = os.sched_getaffinity(0) if hasattr(os, "sched_getaffinity") else None
+mdl1i = mdpsolver.model()
+mdl1i.mdp(discount=0.95, rewards=rewards, tranMatWithZeros=tranMatWithZeros)
+mdl1i.solve(algorithm="mpi", update="standard", pinThreads=True)
+if cpus1i is not None and os.sched_getaffinity(0) != cpus1i:
+    sys.exit("Model 1i failed!")  # the binding must end with the solve
+if not np.array_equal(np.array(mdl1i.getPolicy()), np.array([1, 1, 0])):
+    sys.exit("Model 1i failed!")
+if not np.array_equal(
+    np.round(np.array(mdl1i.getValueVector()), 3),
+    np.round(np.array([200.0011471819124, 212.86672887958622, 298.7090458676583]), 3),
+):
+    sys.exit("Model 1i failed!")
+
+# Model 1j (work stealing over the chunks of states)
+mdl1j = mdpsolver.model()
+mdl1j.mdp(discount=0.95, rewards=rewards, tranMatWithZeros=tranMatWithZeros)
+mdl1j.solve(algorithm="mpi", update="standard", workStealing=True)
+if not np.array_equal(np.array(mdl1j.getPolicy()), np.array([1, 1, 0])):
+    sys.exit("Model 1j failed!")
+if not np.array_equal(
+    np.round(np.array(mdl1j.getValueVector()), 3),
+    np.round(np.array([200.0011471819124, 212.86672887958622, 298.7090458676583]), 3),
+):
+    sys.exit("Model 1j failed!")
+
+# Model 1k (mixed precision)
+mdl1k = mdpsolver.model()
+mdl1k.mdp(discount=0.95, rewards=rewards, tranMatWithZeros=tranMatWithZeros)
+mdl1k.solve(algorithm="mpi", update="standard", mixedPrecision=True)
+if not np.array_equal(np.array(mdl1k.getPolicy()), np.array([1, 1, 0])):
+    sys.exit("Model 1k failed!")
+if not np.array_equal(
+    np.round(np.array(mdl1k.getValueVector()), 3),
+    np.round(np.array([200.0011471819124, 212.86672887958622, 298.7090458676583]), 3),
+):
+    sys.exit("Model 1k failed!")
+
+# Model 1l (binary model file)
+with tempfile.TemporaryDirectory() as tempDir:
+    modelFile = tempDir + "/model1l.bin"
+    mdl1k.saveModel(fileName=modelFile)
+    mdl1l = mdpsolver.model()
+    mdl1l.mdp(discount=0.95, modelFromFile=modelFile)
+    mdl1l.solve(algorithm="mpi", update="standard", initPolicy=initPolicy)
+    if not np.array_equal(np.array(mdl1l.getPolicy()), np.array([1, 1, 0])):
+        sys.exit("Model 1l failed!")
+    if not np.array_equal(
+        np.round(np.array(mdl1l.getValueVector()), 3),
+        np.round(np.array([200.00114718191236, 212.86672887958622, 298.7090458676583]), 3),
+    ):
+        sys.exit("Model 1l failed!")
+    del mdl1l
+    # a column index that is not a state must be rejected when the file is opened
+    with open(modelFile, "rb") as file:
+        modelBytes = bytearray(file.read())
+    flags = struct.unpack_from("<q", modelBytes, 56)[0]
+    sections = struct.unpack_from("<9q", modelBytes, 64)
+    struct.pack_into("<i", modelBytes, sections[4] if flags & 1 else sections[3], 3)  # first column (base) of row 0
+    with open(modelFile, "wb") as file:
+        file.write(modelBytes)
+    mdl1l = mdpsolver.model()
+    mdl1l.mdp(discount=0.95, modelFromFile=modelFile)
+    mdl1l.solve(algorithm="mpi", update="standard")
+    if len(mdl1l.getPolicy()) != 0:
+        sys.exit("Model 1l failed!")
+    del mdl1l
+    # so must a number of non-zeros whose sections would not fit in the file
+    struct.pack_into("<i", modelBytes, sections[4] if flags & 1 else sections[3], 0)
+    nRows = struct.unpack_from("<q", modelBytes, 24)[0]
+    struct.pack_into("<q", modelBytes, 32, 2**62)  # nnz
+    struct.pack_into("<q", modelBytes, sections[1] + 8 * nRows, 2**62)  # last row offset
+    with open(modelFile, "wb") as file:
+        file.write(modelBytes)
+    mdl1l = mdpsolver.model()
+    mdl1l.mdp(discount=0.95, modelFromFile=modelFile)
+    mdl1l.solve(algorithm="mpi", update="standard")
+    if len(mdl1l.getPolicy()) != 0:
+        sys.exit("Model 1l failed!")
+    del mdl1l
+
+# Model 1m (NumPy arrays and SciPy sparse matrices)
+arrayInputs = [
+    dict(rewards=np.array(rewards, dtype=float), tranMatWithZeros=np.array(tranMatWithZeros)),
+    dict(
+        rewardsElementwise=np.array([[s, a, rewards[s][a]] for s in range(3) for a in range(2)]),
+        tranMatElementwise=np.array(
+            [[s, a, j, tranMatWithZeros[s][a][j]] for s in range(3) for a in range(2) for j in range(3) if tranMatWithZeros[s][a][j] > 0]
+        ),
+    ),
+]
+try:
+    import scipy.sparse
+
+    arrayInputs.append(dict(rewards=np.array(rewards, dtype=float), tranMatSparse=scipy.sparse.csr_matrix(np.array(tranMatWithZeros).reshape(6, 3))))
+    arrayInputs.append(dict(rewards=rewards, tranMatSparse=[scipy.sparse.coo_matrix(np.array(tranMatWithZeros)[:, a, :]) for a in range(2)]))
+except ImportError:
+    pass
+for inputs in arrayInputs:
+    mdl1m = mdpsolver.model()
+    mdl1m.mdp(discount=0.95, **inputs)
+    mdl1m.solve(algorithm="mpi", update="standard", initPolicy=initPolicy)
+    if not np.array_equal(np.array(mdl1m.getPolicy()), np.array([1, 1, 0])):
+        sys.exit("Model 1m failed!")
+    if not np.array_equal(
+        np.round(np.array(mdl1m.getValueVector()), 3),
+        np.round(np.array([200.00114718191236, 212.86672887958622, 298.7090458676583]), 3),
+    ):
+        sys.exit("Model 1m failed!")
+
+# Model 1n (NumPy results)
+mdl1n = mdpsolver.model()
+mdl1n.mdp(discount=0.95, rewards=rewards, tranMatWithZeros=tranMatWithZeros)
+mdl1n.solve(algorithm="mpi", update="standard", initPolicy=initPolicy)
+policyArray = mdl1n.getPolicyArray()
+valueArray = mdl1n.getValueVectorArray()
+if not np.array_equal(policyArray, np.array([1, 1, 0])) or not np.array_equal(mdl1n.getActions([2, 0, 3]), np.array([0, 1, -1])):
+    sys.exit("Model 1n failed!")
+if not np.array_equal(
+    np.round(valueArray, 3),
+    np.round(np.array([200.00114718191236, 212.86672887958622, 298.7090458676583]), 3),
+):
+    sys.exit("Model 1n failed!")
+mdl1n.mdp(discount=0.5, rewards=rewards, tranMatWithZeros=tranMatWithZeros)
+mdl1n.solve(algorithm="mpi", update="standard")
+if not np.array_equal(np.round(valueArray, 3), np.round(np.array([200.00114718191236, 212.86672887958622, 298.7090458676583]), 3)):
+    sys.exit("Model 1n failed!")
+
+# Model 1o (concurrent solves)
+def solveModel1o(discount):
+    mdl = mdpsolver.model()
+    mdl.mdp(discount=discount, rewards=rewards, tranMatWithZeros=tranMatWithZeros)
+    mdl.solve(algorithm="mpi", update="standard", initPolicy=initPolicy)
+    return mdl
+
+with concurrent.futures.ThreadPoolExecutor(max_workers=4) as executor:
+    mdls1o = list(executor.map(solveModel1o, [0.95] * 4))
+for mdl1o in mdls1o:
+    if not np.array_equal(np.array(mdl1o.getPolicy()), np.array([1, 1, 0])):
+        sys.exit("Model 1o failed!")
+    if not np.array_equal(
+        np.round(np.array(mdl1o.getValueVector()), 3),
+        np.round(np.array([200.00114718191236, 212.86672887958622, 298.7090458676583]), 3),
+    ):
+        sys.exit("Model 1o failed!")
+
+# Model 1f (BiCGSTAB policy evaluation)
+mdl1f = mdpsolver.model()
+mdl1f.mdp(discount=0.95, rewards=rewards, tranMatWithZeros=tranMatWithZeros)
+mdl1f.solve(algorithm="mpi", update="standard", evaluation="bicgstab", initPolicy=initPolicy)
+if not np.array_equal(np.array(mdl1f.getPolicy()), np.array([1, 1, 0])):
+    sys.exit("Model 1f failed!")
+if not np.array_equal(
+    np.round(np.array(mdl1f.getValueVector()), 3),
+    np.round(np.array([200.0012771893156, 212.86686671568802, 298.7091798650016]), 3),
+):
+    sys.exit("Model 1f failed!")
+
+# Model 2f (GMRES policy evaluation)
+mdl2f = mdpsolver.model()
+mdl2f.mdp(discount=0.95, rewards=rewards, tranMatWithZeros=tranMatWithZeros)
+mdl2f.solve(algorithm="pi", update="standard", evaluation="gmres", initPolicy=initPolicy)
+if not np.array_equal(np.array(mdl2f.getPolicy()), np.array([1, 1, 0])):
+    sys.exit("Model 2f failed!")
+if not np.array_equal(
+    np.round(np.array(mdl2f.getValueVector()), 3),
+    np.round(np.array([200.0012771893156, 212.86686671568802, 298.7091798650016]), 3),
+):
+    sys.exit("Model 2f failed!")
+
+# Model 2g (policy evaluation with the sparse LU factorization)
+mdl2g = mdpsolver.model()
+mdl2g.mdp(discount=0.95, rewards=rewards, tranMatWithZeros=tranMatWithZeros)
+mdl2g.solve(algorithm="pi", update="standard", evaluation="direct", initPolicy=initPolicy)
+if not np.array_equal(np.array(mdl2g.getPolicy()), np.array([1, 1, 0])):
+    sys.exit("Model 2g failed!")
+if not np.array_equal(
+    np.round(np.array(mdl2g.getValueVector()), 3),
+    np.round(np.array([200.0012771893156, 212.86686671568802, 298.7091798650016]), 3),
+):
+    sys.exit("Model 2g failed!")
+
+# Model 1g (strongly connected components solved first)
+mdl1g = mdpsolver.model()
+mdl1g.mdp(discount=0.95, rewards=rewards, tranMatWithZeros=tranMatWithZeros)
+mdl1g.solve(algorithm="mpi", update="standard", initPolicy=initPolicy, decompose=True)
+if not np.array_equal(np.array(mdl1g.getPolicy()), np.array([1, 1, 0])):
+    sys.exit("Model 1g failed!")
+if not np.array_equal(
+    np.round(np.array(mdl1g.getValueVector()), 3),
+    np.round(np.array([200.0012771893156, 212.86686671568802, 298.7091798650016]), 3),
+):
+    sys.exit("Model 1g failed!")
+
 # ---------------------------------------
 # CONFIGURATION 2
 # ---------------------------------------
@@ -472,7 +785,7 @@ if not np.array_equal(np.array(mdl3d.getPolicy()), np.array([1, 1, 0])):
     sys.exit("Model 3d failed!")
 if not np.array_equal(
     np.round(np.array(mdl3d.getValueVector()), 3),
-    np.round(np.array([206.69740452375487, 222.30968454932525, 305.91165352015094]), 3),
+    np.round(np.array([200.00127192706978, 212.86686213417138, 298.7091756904488]), 3),
 ):
     sys.exit("Model 3d failed!")
 
@@ -710,8 +1023,134 @@ if not np.array_equal(np.array(mdl3d.getPolicy()), np.array([1, 1, 0])):
     sys.exit("Model 3d failed!")
 if not np.array_equal(
     np.round(np.array(mdl3d.getValueVector()), 3),
-    np.round(np.array([206.69740452375487, 222.30968454932525, 305.91165352015094]), 3),
+    np.round(np.array([200.00127192706978, 212.86686213417138, 298.7091756904488]), 3),
 ):
     sys.exit("Model 3d failed!")
 
+# ---------------------------------------
+# CONFIGURATION 4
+# ---------------------------------------
+
+# time-based (TBM) and condition-based (CBM) maintenance models, which are
+# computed by the solver module instead of being given as lists
+def sameValues(values, reference):
+    return np.max(np.abs(np.array(values) - np.array(reference))) < 1e-3
+
+# reference values (serial Gauss-Seidel)
+tbmReference = solvermodule.Model()
+tbmReference.tbm(discount=0.95, components=3, stages=6)
+tbmReference.solve(algorithm="vi", update="gs", parallel=False, tolerance=1e-6)
+tbmValues = tbmReference.getValueVector()
+
+# Model 1e, 2e, 3e (SOR, parallel). SOR converges for the serial order of the states,
+# but not for the order of the colors, so the relaxation must be reduced.
+for algorithm in ["mpi", "pi", "vi"]:
+    mdlTbm = solvermodule.Model()
+    mdlTbm.tbm(discount=0.95, components=3, stages=6)
+    mdlTbm.solve(algorithm=algorithm, update="sor", SORrelaxation=1.1, parallel=True, tolerance=1e-6)
+    if not sameValues(mdlTbm.getValueVector(), tbmValues) or mdlTbm.getSORrelaxation() >= 1.1:
+        sys.exit("TBM model (" + algorithm + ", SOR, parallel) failed!")
+
+# Model 1a, 2a, 3a (parallel) against 1b, 2b, 3b (unparallel) on the TBM and CBM models,
+# whose transition probabilities are computed in each row
+def maintenanceModel(modelType):
+    mdl = solvermodule.Model()
+    if modelType == "tbm":
+        mdl.tbm(discount=0.95, components=3, stages=6)
+    else:
+        mdl.cbm(discount=0.95, components=3, stages=5, pCompMat=[[0.6, 0.2, 0.1, 0.05, 0.05]] * 3)
+    return mdl
+
+for modelType in ["tbm", "cbm"]:
+    for algorithm in ["mpi", "pi", "vi"]:
+        mdlSerial = maintenanceModel(modelType)
+        mdlSerial.solve(algorithm=algorithm, parallel=False, tolerance=1e-6)
+        mdlParallel = maintenanceModel(modelType)
+        mdlParallel.solve(algorithm=algorithm, parallel=True, tolerance=1e-6)
+        if not np.array_equal(np.array(mdlParallel.getPolicy()), np.array(mdlSerial.getPolicy())):
+            sys.exit(modelType.upper() + " model (" + algorithm + ", parallel) failed!")
+        if not sameValues(mdlParallel.getValueVector(), mdlSerial.getValueVector()):
+            sys.exit(modelType.upper() + " model (" + algorithm + ", parallel) failed!")
+
+# Model 1a, 3a (parallel) against 1b, 3b (unparallel) under both criteria. The parallel updates
+# reduce the span of the differences in the same loop as the values, and must stop in the same
+# iteration as the unparallel updates, which compute the same values in each iteration.
+for criterion in ["discounted", "average"]:
+    for algorithm in ["mpi", "vi"]:
+        mdlSerial = maintenanceModel("tbm")
+        mdlSerial.solve(algorithm=algorithm, criterion=criterion, parallel=False, tolerance=1e-6)
+        mdlParallel = maintenanceModel("tbm")
+        mdlParallel.solve(algorithm=algorithm, criterion=criterion, parallel=True, tolerance=1e-6)
+        if not np.array_equal(np.array(mdlParallel.getValueVector()), np.array(mdlSerial.getValueVector())):
+            sys.exit("TBM model (" + algorithm + ", " + criterion + " reward, parallel) failed!")
+
+# Model 1c, 3c (Gauss-Seidel, parallel), which stop with the supremum norm of the differences
+for algorithm in ["mpi", "vi"]:
+    mdlParallel = maintenanceModel("tbm")
+    mdlParallel.solve(algorithm=algorithm, update="gs", parallel=True, tolerance=1e-6)
+    if not sameValues(mdlParallel.getValueVector(), tbmValues):
+        sys.exit("TBM model (" + algorithm + ", Gauss-Seidel, parallel) failed!")
+
+# Model 1q (rows of the transition matrix). The rows are enumerated from the post-decision state
+# of the TBM and CBM models, and must contain every state that the transition probability function
+# of the models below reaches, with the same probability.
+def tbmTransProb(sidx, aidx, jidx, N, L, f=0.1, fmin=0.01, fhat=0.1):
+    s = [sidx // (L + 1) ** i % (L + 1) for i in range(N)]
+    j = [jidx // (L + 1) ** i % (L + 1) for i in range(N)]
+    a = [aidx // 2 ** i % 2 for i in range(N)]
+    prob = 1.0
+    for i in range(N):
+        if a[i] == 1:
+            prob *= j[i] == L
+        elif s[i] > 1:
+            failProb = f - (f - fmin) * (s[i] - 1.0) / (L - 1.0)
+            if N > 1:
+                failProb += fhat * ((N - 1.0) * L - (sum(s) - s[i])) / ((N - 1.0) * L)
+            prob *= failProb if j[i] == 0 else (1.0 - failProb if j[i] == s[i] - 1 else 0.0)
+        else:
+            prob *= j[i] == 0
+    return prob
+
+def cbmTransProb(sidx, aidx, jidx, N, L, pCompMat):
+    s = [sidx // (L + 1) ** i % (L + 1) for i in range(N)]
+    j = [jidx // (L + 1) ** i % (L + 1) for i in range(N)]
+    a = [aidx // 2 ** i % 2 for i in range(N)]
+    prob = 1.0
+    for i in range(N):
+        if a[i] == 1:
+            prob *= pCompMat[i][j[i]]
+        elif j[i] < s[i]:
+            prob *= 0.0
+        elif j[i] < L:
+            prob *= pCompMat[i][j[i] - s[i]]
+        else:
+            prob *= sum(pCompMat[i][L - s[i] :])  # failed, from any level at least s[i]
+    return prob
+
+def sameRow(row, transProb, nStates):
+    columns = [column for column, probability in row]
+    if len(set(columns)) != len(columns) or min(columns) < 0 or max(columns) >= nStates:
+        return False
+    probabilities = dict(row)
+    return all(abs(probabilities.get(jidx, 0.0) - transProb(jidx)) < 1e-12 for jidx in range(nStates))
+
+mdl1q = solvermodule.Model()
+mdl1q.mdp(discount=0.95, rewards=rewards, tranMatWithZeros=tranMatWithZeros)
+for sidx in range(3):
+    for aidx in range(2):
+        if not sameRow(mdl1q.getTransitionRow(sidx, aidx), lambda jidx: tranMatWithZeros[sidx][aidx][jidx], 3):
+            sys.exit("Model 1q failed!")
+
+pCompMat1q = [[0.6, 0.25, 0.1, 0.05], [0.5, 0.3, 0.2, 0.0], [0.7, 0.1, 0.1, 0.1]]
+tbm1q = solvermodule.Model()
+tbm1q.tbm(discount=0.95, components=3, stages=4)
+cbm1q = solvermodule.Model()
+cbm1q.cbm(discount=0.95, components=3, stages=4, pCompMat=pCompMat1q)
+for sidx in range(64):
+    for aidx in range(8):
+        if not sameRow(tbm1q.getTransitionRow(sidx, aidx), lambda jidx: tbmTransProb(sidx, aidx, jidx, 3, 3), 64):
+            sys.exit("TBM model (rows) failed!")
+        if not sameRow(cbm1q.getTransitionRow(sidx, aidx), lambda jidx: cbmTransProb(sidx, aidx, jidx, 3, 3, pCompMat1q), 64):
+            sys.exit("CBM model (rows) failed!")
+
 print("Test 1 succesfully reproduced output!")